@@ -1,9 +1,73 @@
 #include "actuators.h"
 
+// Servo travel limits and motion profiles, degrees and degrees per second
+static const int WINDOW_MAX_ANGLE = 90;
+static const float DOOR_MAX_SPEED = 90.0;
+static const float DOOR_ACCELERATION = 180.0;
+static const float WINDOW_MAX_SPEED = 45.0;
+static const float WINDOW_ACCELERATION = 90.0;
+
+// Default fan ramp, PWM counts per second; spinning down needs no care
+static const float FAN_SLEW_UP = 100.0;
+static const float FAN_SLEW_DOWN = 255.0;
+
+// LED strip and light mode colors
+static const uint16_t LED_COUNT = 30;
+static const CRGB NORMAL_LIGHT_COLOR = CRGB(255, 180, 110);   // Warm white
+static const CRGB NIGHT_LIGHT_COLOR = CRGB(255, 60, 0);
+static const uint8_t NIGHT_LIGHT_LEVEL = 24;
+static const uint16_t MODE_FADE_TIME = 500;
+static const uint16_t PARTY_PERIOD = 4000;
+static const uint16_t LIGHT_SHOW_PERIOD = 2000;
+static const uint16_t ALERT_BLINK_PERIOD = 500;
+
+// Buzzer sounds, frequencies in Hz and durations in ms
+static const unsigned int BUZZER_FREQUENCY = 2000;
+static const int ALARM_NOTES[] PROGMEM = {960, 770};
+static const int ALARM_DURATIONS[] PROGMEM = {250, 250};
+// ISO 8201 temporal-three evacuation signal
+static const int EVACUATION_NOTES[] PROGMEM = {3100, 0, 3100, 0, 3100, 0};
+static const int EVACUATION_DURATIONS[] PROGMEM = {500, 500, 500, 500, 500, 1500};
+
+// Timer wheel actions: actuator in the high byte, value in the low byte
+static const uint16_t ACTION_FAN = 0x0100;
+static const uint16_t ACTION_WINDOW = 0x0200;
+static const uint16_t ACTION_DOOR = 0x0300;
+static const uint16_t ACTION_ALARM = 0x0400;
+
 void Actuators::begin() {
     // Fix: Add proper pin mode initialization
     pinMode(fanPin, OUTPUT);
-    pinMode(buzzerPin, OUTPUT);
+    toneSequencer.begin(buzzerPin);
+    
+    // Nothing requested yet, direct calls count as user requests
+    memset(intents, 0, sizeof(intents));
+    intentSource = SOURCE_USER;
+    intentsRequested = 0;
+    writesApplied = 0;
+    lightAlert = false;
+    
+    // No schedules until they are set
+    for (uint8_t i = 0; i < 2; i++) {
+        fanSchedule[i] = 0;
+        windowSchedule[i] = 0;
+        doorSchedule[i] = 0;
+    }
+    autoCloseTimer = 0;
+    autoCloseTime = 0;
+    alarmTimer = 0;
+    alarmNotes = NULL;
+    alarmDurations = NULL;
+    alarmCount = 0;
+    
+    // The fan starts stopped, its PWM is tracked here from now on
+    fanPwm = 0;
+    fanTarget = 0;
+    fanSlewUp = FAN_SLEW_UP;
+    fanSlewDown = FAN_SLEW_DOWN;
+    lastFanStep = millis();
+    currentFanSpeed = OFF;
+    analogWrite(fanPin, 0);
     
     // Fix: Add servo initialization with error checking
     bool doorServoInitialized = false;
@@ -25,26 +89,163 @@ void Actuators::begin() {
         return;
     }
     
+    // Plan from wherever the servos were last commanded
+    doorMotion = ServoMotion(DOOR_MAX_SPEED, DOOR_ACCELERATION);
+    windowMotion = ServoMotion(WINDOW_MAX_SPEED, WINDOW_ACCELERATION);
+    doorAngle = doorServo.read();
+    windowAngle = windowServo.read();
+    doorMotion.reset(doorAngle);
+    windowMotion.reset(windowAngle);
+    motionEvents = 0;
+    
     // Fix: Initialize LED strip with error checking
-    leds = new CRGB[30];
+    leds = new CRGB[LED_COUNT];
     if (!leds) {
         systemActive = false;
         return;
     }
     
     // Fix: Add proper FastLED initialization
-    FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, 30);
+    FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, LED_COUNT);
     FastLED.setCorrection(TypicalLEDStrip);
     FastLED.setTemperature(DirectSunlight);
     FastLED.setMaxPowerInVoltsAndMilliamps(5, 500);  // 5V, 500mA
     
-    // Set initial states
-    setDoorState(LOCKED);
-    setWindowOpening(0);
+    // Set initial states, the servos get there through tick()
+    systemActive = true;
+    applyDoorState(LOCKED);
+    applyWindowOpening(0);
     FastLED.clear();
     FastLED.show();
     
-    systemActive = true;
+    // Lights start off in normal mode, frames are rendered from tick()
+    lights.begin(leds, LED_COUNT);
+    ambientColor = NORMAL_LIGHT_COLOR;
+    currentLightLevel = 0;
+    lights.setLevel(LAYER_BASE, 0);
+    applyLightMode(NORMAL);
+}
+
+void Actuators::tick() {
+    unsigned long now = millis();
+    
+    commitIntents();
+    
+    if (driveServo(doorServo, doorMotion, doorAngle, now)) {
+        motionEvents |= MOTION_DOOR_DONE;
+        lastDoorOperation = now;
+    }
+    if (driveServo(windowServo, windowMotion, windowAngle, now)) {
+        motionEvents |= MOTION_WINDOW_DONE;
+    }
+    driveFan(now);
+    lights.render(now);
+    toneSequencer.service();
+}
+
+bool Actuators::driveServo(Servo& servo, ServoMotion& motion, int& written, unsigned long now) {
+    bool done = motion.update(now);
+    
+    // Servo resolution is one degree, skip writes that would not move it
+    int angle = (int)(motion.position() + 0.5);
+    if (angle != written) {
+        servo.write(angle);
+        written = angle;
+    }
+    return done;
+}
+
+void Actuators::setIntentSource(IntentSource source) {
+    intentSource = source;
+}
+
+void Actuators::requestIntent(IntentTarget target, int value) {
+    // Same or higher priority replaces what is pending or was written this
+    // cycle, lower is dropped
+    Intent& intent = intents[target];
+    intentsRequested++;
+    if ((!intent.pending && !intent.held) || intentSource >= intent.source) {
+        intent.value = value;
+        intent.source = intentSource;
+        intent.pending = true;
+    }
+}
+
+void Actuators::commitIntents() {
+    for (uint8_t i = 0; i < TARGET_COUNT; i++) {
+        IntentTarget target = static_cast<IntentTarget>(i);
+        Intent& intent = intents[target];
+        if (!intent.pending) continue;
+        intent.pending = false;
+        intent.held = true;
+        
+        // Skip writes that would not change anything
+        if (intent.value == appliedValue(target)) continue;
+        applyIntent(target, intent.value);
+        writesApplied++;
+    }
+}
+
+void Actuators::beginIntentCycle() {
+    for (uint8_t i = 0; i < TARGET_COUNT; i++) {
+        intents[i].held = false;
+    }
+}
+
+int Actuators::appliedValue(IntentTarget target) {
+    switch (target) {
+        case TARGET_FAN: return fanTarget;
+        case TARGET_WINDOW: return currentWindowOpening;
+        case TARGET_DOOR: return currentDoorState;
+        case TARGET_LIGHT_MODE: return lightAlert ? ALERT : currentLightMode;
+        case TARGET_LIGHT_LEVEL: return currentLightLevel;
+        default: return -1;
+    }
+}
+
+void Actuators::applyIntent(IntentTarget target, int value) {
+    switch (target) {
+        case TARGET_FAN:
+            applyFan(static_cast<FanSpeed>(value));
+            break;
+        case TARGET_WINDOW:
+            applyWindowOpening(value);
+            break;
+        case TARGET_DOOR:
+            applyDoorState(static_cast<DoorState>(value));
+            break;
+        case TARGET_LIGHT_MODE:
+            applyLightMode(static_cast<LightMode>(value));
+            break;
+        case TARGET_LIGHT_LEVEL:
+            applyLight(value);
+            break;
+        default:
+            break;
+    }
+}
+
+unsigned long Actuators::getWritesApplied() const {
+    return writesApplied;
+}
+
+unsigned long Actuators::getWritesAvoided() const {
+    return intentsRequested - writesApplied;
+}
+
+void Actuators::printIntentStats(Print& out) const {
+    out.print(F("Actuator intents: "));
+    out.print(intentsRequested);
+    out.print(F(", writes: "));
+    out.print(writesApplied);
+    out.print(F(", avoided: "));
+    out.println(getWritesAvoided());
+}
+
+uint8_t Actuators::pollMotionEvents() {
+    uint8_t events = motionEvents;
+    motionEvents = 0;
+    return events;
 }
 
 void Actuators::setDoorState(DoorState state) {
@@ -56,6 +257,11 @@ void Actuators::setDoorState(DoorState state) {
         return;
     }
     
+    if (state != LOCKED && state != UNLOCKED && state != PARTIALLY_OPEN) return;
+    requestIntent(TARGET_DOOR, state);
+}
+
+void Actuators::applyDoorState(DoorState state) {
     // Fix: Add proper servo angle validation
     int angle;
     switch (state) {
@@ -72,37 +278,240 @@ void Actuators::setDoorState(DoorState state) {
             return;  // Invalid state
     }
     
-    // Fix: Add smooth servo movement
-    int currentAngle = doorServo.read();
-    int step = (angle > currentAngle) ? 1 : -1;
+    // Planned move, tick() drives the servo and raises MOTION_DOOR_DONE
+    doorMotion.moveTo(angle);
+    currentDoorState = state;
     
-    for (int i = currentAngle; i != angle; i += step) {
-        doorServo.write(i);
-        delay(15);  // Smooth movement
+    // Restart the auto-close countdown on every opening
+    timers.cancel(autoCloseTimer);
+    autoCloseTimer = 0;
+    if (state != LOCKED && autoCloseTime > 0) {
+        autoCloseTimer = timers.schedule(autoCloseTime, scheduledAction, this, ACTION_DOOR | LOCKED);
     }
+}
+
+void Actuators::autoCloseDoor(unsigned long delay) {
+    // Armed whenever the door is opened, 0 disables
+    autoCloseTime = delay;
+    timers.cancel(autoCloseTimer);
+    autoCloseTimer = 0;
+    if (delay > 0 && currentDoorState != LOCKED) {
+        autoCloseTimer = timers.schedule(delay, scheduledAction, this, ACTION_DOOR | LOCKED);
+    }
+}
+
+void Actuators::setDoorSchedule(int openHour, int closeHour) {
+    replaceSchedule(doorSchedule, openHour, closeHour, ACTION_DOOR | UNLOCKED, ACTION_DOOR | LOCKED);
+}
+
+void Actuators::setWindowSchedule(int openHour, int closeHour) {
+    replaceSchedule(windowSchedule, openHour, closeHour, ACTION_WINDOW | 100, ACTION_WINDOW | 0);
+}
+
+void Actuators::setFanSchedule(int startHour, int endHour, FanSpeed speed) {
+    replaceSchedule(fanSchedule, startHour, endHour, ACTION_FAN | speed, ACTION_FAN | OFF);
+}
+
+void Actuators::replaceSchedule(TimerHandle* handles, int startHour, int endHour, uint16_t startAction,
+                                uint16_t endAction) {
+    // Out-of-range or equal hours just clear the schedule
+    timers.cancel(handles[0]);
+    timers.cancel(handles[1]);
+    handles[0] = 0;
+    handles[1] = 0;
+    if (startHour < 0 || startHour > 23 || endHour < 0 || endHour > 23 || startHour == endHour) return;
     
-    currentDoorState = state;
-    lastDoorOperation = millis();
+    handles[0] = timers.scheduleDaily(startHour, 0, scheduledAction, this, startAction);
+    handles[1] = timers.scheduleDaily(endHour, 0, scheduledAction, this, endAction);
+}
+
+void Actuators::scheduledAction(void* context, uint16_t action) {
+    // Goes through the intent buffer like any other request
+    Actuators* actuators = static_cast<Actuators*>(context);
+    uint8_t value = action & 0xFF;
+    switch (action & 0xFF00) {
+        case ACTION_FAN:
+            actuators->setFan(static_cast<FanSpeed>(value));
+            break;
+        case ACTION_WINDOW:
+            actuators->setWindowOpening(value);
+            break;
+        case ACTION_DOOR:
+            actuators->setDoorState(static_cast<DoorState>(value));
+            break;
+        case ACTION_ALARM:
+            toneSequencer.play(actuators->alarmNotes, actuators->alarmDurations, actuators->alarmCount,
+                               TONE_ALARM);
+            break;
+        default:
+            break;
+    }
+}
+
+DoorState Actuators::getDoorState() {
+    return currentDoorState;
+}
+
+bool Actuators::isDoorMoving() {
+    return doorMotion.isMoving();
+}
+
+void Actuators::setWindowOpening(int percentage) {
+    if (!systemActive) return;
+    requestIntent(TARGET_WINDOW, constrain(percentage, 0, 100));
+}
+
+void Actuators::applyWindowOpening(int percentage) {
+    windowMotion.moveTo(percentage * WINDOW_MAX_ANGLE / 100.0);
+    currentWindowOpening = percentage;
+}
+
+int Actuators::getWindowOpening() {
+    // Actual position while moving, not the target
+    return (int)(windowMotion.position() * 100 / WINDOW_MAX_ANGLE + 0.5);
+}
+
+bool Actuators::isWindowMoving() {
+    return windowMotion.isMoving();
+}
+
+void Actuators::setLight(int brightness) {
+    requestIntent(TARGET_LIGHT_LEVEL, constrain(brightness, 0, 255));
+}
+
+void Actuators::applyLight(int brightness) {
+    currentLightLevel = brightness;
+    lights.setLevel(LAYER_BASE, currentLightLevel);
+}
+
+void Actuators::fadeLight(int targetBrightness, int duration) {
+    // An explicit transition, supersedes any level requested this pass
+    intents[TARGET_LIGHT_LEVEL].pending = false;
+    currentLightLevel = constrain(targetBrightness, 0, 255);
+    lights.setLevel(LAYER_BASE, currentLightLevel, constrain(duration, 0, 65535));
+}
+
+void Actuators::pulseLight(int duration) {
+    // A single white swell over the current scene; the renderer takes 16-bit periods
+    uint16_t period = min((unsigned long)max(duration, 0), 65535UL);
+    lights.setPulse(LAYER_EFFECT, CRGB::White, period, period);
+}
+
+void Actuators::setLightMode(LightMode mode) {
+    requestIntent(TARGET_LIGHT_MODE, mode);
+}
+
+void Actuators::applyLightMode(LightMode mode) {
+    if (mode == ALERT) {
+        // Drawn over the room lighting, which keeps running underneath
+        lights.setBlink(LAYER_ALERT, CRGB::Red, ALERT_BLINK_PERIOD);
+        lightAlert = true;
+        return;
+    }
+    
+    clearLightAlert();
+    switch (mode) {
+        case NORMAL:
+            lights.setSolid(LAYER_BASE, NORMAL_LIGHT_COLOR);
+            lights.setLevel(LAYER_BASE, currentLightLevel, MODE_FADE_TIME);
+            break;
+        case AMBIENT:
+            lights.setSolid(LAYER_BASE, ambientColor);
+            lights.setLevel(LAYER_BASE, currentLightLevel, MODE_FADE_TIME);
+            break;
+        case NIGHT:
+            lights.setSolid(LAYER_BASE, NIGHT_LIGHT_COLOR);
+            lights.setLevel(LAYER_BASE, min(currentLightLevel, (int)NIGHT_LIGHT_LEVEL), MODE_FADE_TIME);
+            break;
+        case PARTY:
+            lights.setPalette(LAYER_BASE, PartyColors_p, PARTY_PERIOD);
+            lights.setLevel(LAYER_BASE, 255, MODE_FADE_TIME);
+            break;
+        default:
+            return;
+    }
+    currentLightMode = mode;
+}
+
+void Actuators::clearLightAlert() {
+    lights.clear(LAYER_ALERT);
+    lightAlert = false;
+}
+
+void Actuators::setAmbientColor(uint8_t r, uint8_t g, uint8_t b) {
+    ambientColor = CRGB(r, g, b);
+    if (currentLightMode == AMBIENT) lights.setColor(LAYER_BASE, ambientColor);
+}
+
+void Actuators::startLightShow(int duration) {
+    lights.setPalette(LAYER_EFFECT, RainbowColors_p, LIGHT_SHOW_PERIOD, (unsigned long)max(duration, 0));
+}
+
+void Actuators::triggerBuzzer(unsigned long duration) {
+    toneSequencer.playTone(BUZZER_FREQUENCY, min(duration, 65535UL), TONE_ALERT);
+}
+
+void Actuators::playMelody(const int* notes, const int* durations, int count) {
+    toneSequencer.play(notes, durations, constrain(count, 0, 255), TONE_CHIME);
+}
+
+void Actuators::stopBuzzer() {
+    toneSequencer.stop();
+}
+
+void Actuators::triggerAlarm() {
+    toneSequencer.play(ALARM_NOTES, ALARM_DURATIONS, 2, TONE_ALARM, true);
+}
+
+void Actuators::triggerEvacuationAlarm() {
+    toneSequencer.play(EVACUATION_NOTES, EVACUATION_DURATIONS, 6, TONE_EVACUATION, true);
+}
+
+void Actuators::setAlarm(int hour, int minute, const int* melody, const int* durations, int count) {
+    // Daily alarm; an invalid time or an empty melody just clears it
+    timers.cancel(alarmTimer);
+    alarmTimer = 0;
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || !melody || !durations || count <= 0) return;
+    
+    alarmNotes = melody;
+    alarmDurations = durations;
+    alarmCount = min(count, 255);
+    alarmTimer = timers.scheduleDaily(hour, minute, scheduledAction, this, ACTION_ALARM);
 }
 
 void Actuators::setFan(FanSpeed speed) {
-    // Fix: Add proper validation and ramping
     if (!systemActive || nightMode) return;
+    requestIntent(TARGET_FAN, speed);
+}
+
+void Actuators::applyFan(FanSpeed speed) {
+    // Only the target changes, an in-flight ramp carries on from where it is
+    fanTarget = speed;
+    currentFanSpeed = speed;
+}
+
+void Actuators::setFanSlewRate(float upRate, float downRate) {
+    if (upRate > 0) fanSlewUp = upRate;
+    if (downRate > 0) fanSlewDown = downRate;
+}
+
+void Actuators::driveFan(unsigned long now) {
+    if (fanPwm == fanTarget) {
+        lastFanStep = now;
+        return;
+    }
     
-    // Gradually change fan speed
-    int currentSpeed = analogRead(fanPin) / 4;  // Convert 10-bit to 8-bit
-    int targetSpeed = speed;
+    // Whole PWM steps due since the last one, the remainder waits for later passes
+    float rate = fanTarget > fanPwm ? fanSlewUp : fanSlewDown;
+    long steps = (long)((now - lastFanStep) * rate / 1000.0);
+    if (steps < 1) return;
+    // Only the time the steps used is consumed, so slow rates keep their pace
+    lastFanStep += (unsigned long)(steps * 1000.0 / rate);
     
-    // Ramp up/down gradually
-    while (currentSpeed != targetSpeed) {
-        if (currentSpeed < targetSpeed) {
-            currentSpeed++;
-        } else {
-            currentSpeed--;
-        }
-        analogWrite(fanPin, currentSpeed);
-        delay(10);  // Smooth transition
+    if (fanTarget > fanPwm) {
+        fanPwm = min((long)fanTarget, fanPwm + steps);
+    } else {
+        fanPwm = max((long)fanTarget, fanPwm - steps);
     }
-    
-    currentFanSpeed = speed;
+    analogWrite(fanPin, fanPwm);
 }
\ No newline at end of file
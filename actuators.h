@@ -4,6 +4,10 @@
 #include <Arduino.h>
 #include <Servo.h>
 #include <FastLED.h>
+#include "servo_motion.h"
+#include "led_renderer.h"
+#include "tone_sequencer.h"
+#include "timer_wheel.h"
 
 enum FanSpeed {
     OFF = 0,
@@ -18,6 +22,20 @@ enum DoorState {
     PARTIALLY_OPEN
 };
 
+// Completion flags returned by Actuators::pollMotionEvents
+enum MotionEvent {
+    MOTION_DOOR_DONE = 0x01,
+    MOTION_WINDOW_DONE = 0x02
+};
+
+// Who asked for an actuator change, later entries win within one cycle
+enum IntentSource {
+    SOURCE_COMFORT,
+    SOURCE_CLIMATE,
+    SOURCE_USER,        // Scenes, voice and network commands
+    SOURCE_SECURITY
+};
+
 enum LightMode {
     NORMAL,
     AMBIENT,
@@ -30,6 +48,20 @@ class Actuators {
 public:
     Actuators(uint8_t ledPin, uint8_t fanPin, uint8_t buzzerPin, uint8_t servoPin, uint8_t windowServoPin);
     void begin();
+    // Apply the last pass's intents, then advance servo motion, the fan
+    // ramp and LED effects; call every loop pass
+    void tick();
+    
+    // Fan, window, door, light mode and light level setters only record an
+    // intent; tick() writes one resolved value per actuator. The source of
+    // each written value holds until beginIntentCycle(), so a cycle spread
+    // over several loop passes can't undo a higher source's request.
+    void setIntentSource(IntentSource source);
+    void commitIntents();
+    void beginIntentCycle();
+    unsigned long getWritesApplied() const;
+    unsigned long getWritesAvoided() const;
+    void printIntentStats(Print& out) const;
     
     // Enhanced lighting control
     void setLight(int brightness);
@@ -38,17 +70,23 @@ public:
     void setLightMode(LightMode mode);
     void setAmbientColor(uint8_t r, uint8_t g, uint8_t b);
     void startLightShow(int duration);
+    void clearLightAlert();
     
     // Advanced fan control
     void setFan(FanSpeed speed);
     void setFanAutoMode(bool enabled, float tempThreshold);
     void setFanSchedule(int startHour, int endHour, FanSpeed speed);
     void updateFanControl(float temperature, float humidity);
+    // Ramp rates in PWM counts per second
+    void setFanSlewRate(float upRate, float downRate);
     
-    // Extended buzzer functionality
+    // Extended buzzer functionality, sounds play in the background; melody
+    // arrays must be in PROGMEM
     void triggerBuzzer(unsigned long duration);
     void playMelody(const int* notes, const int* durations, int count);
     void stopBuzzer();
+    void triggerAlarm();              // Looping siren until stopBuzzer()
+    void triggerEvacuationAlarm();    // Temporal-three pattern, cuts off anything else
     void setAlarm(int hour, int minute, const int* melody, const int* durations, int count);
     
     // Smart door control
@@ -56,12 +94,17 @@ public:
     DoorState getDoorState();
     void autoCloseDoor(unsigned long delay);
     void setDoorSchedule(int openHour, int closeHour);
+    bool isDoorMoving();
     
     // Window control
     void setWindowOpening(int percentage);
     int getWindowOpening();
     void setWindowSchedule(int openHour, int closeHour);
     void updateWindowControl(float temperature, bool isRaining);
+    bool isWindowMoving();
+    
+    // MotionEvent flags raised since the last call
+    uint8_t pollMotionEvents();
     
     // System control
     void emergencyShutdown();
@@ -76,7 +119,43 @@ private:
     uint8_t buzzerPin;
     Servo doorServo;
     Servo windowServo;
+    ServoMotion doorMotion;
+    ServoMotion windowMotion;
+    int doorAngle;            // Last angle written to each servo
+    int windowAngle;
+    uint8_t motionEvents;
+    
+    // Intents collected since the last commit, one slot per actuator
+    enum IntentTarget {
+        TARGET_FAN,
+        TARGET_WINDOW,
+        TARGET_DOOR,
+        TARGET_LIGHT_MODE,
+        TARGET_LIGHT_LEVEL,
+        TARGET_COUNT
+    };
+    struct Intent {
+        int value;
+        uint8_t source;
+        bool pending;
+        bool held;            // Committed this cycle, lower sources are dropped
+    };
+    Intent intents[TARGET_COUNT];
+    IntentSource intentSource;
+    unsigned long intentsRequested;
+    unsigned long writesApplied;
+    bool lightAlert;
+    
+    // Fan PWM as last written, ramped towards the target by tick()
+    uint8_t fanPwm;
+    uint8_t fanTarget;
+    float fanSlewUp;
+    float fanSlewDown;
+    unsigned long lastFanStep;
     CRGB* leds;
+    LedRenderer lights;
+    LightMode currentLightMode;
+    CRGB ambientColor;
     
     // System states
     int currentLightLevel;
@@ -93,34 +172,30 @@ private:
     unsigned long lastDoorOperation;
     unsigned long autoCloseTime;
     
-    // Scheduling
-    struct Schedule {
-        int startHour;
-        int endHour;
-        bool enabled;
-        union {
-            FanSpeed fanSpeed;
-            int windowOpening;
-            DoorState doorState;
-        };
-    };
-    
-    Schedule fanSchedule;
-    Schedule windowSchedule;
-    Schedule doorSchedule;
-    
-    // Light show parameters
-    struct LightShow {
-        bool active;
-        unsigned long startTime;
-        unsigned long duration;
-        uint8_t currentPattern;
-    } lightShow;
+    // Daily schedules run from the timer wheel, start and end task each
+    TimerHandle fanSchedule[2];
+    TimerHandle windowSchedule[2];
+    TimerHandle doorSchedule[2];
+    TimerHandle autoCloseTimer;
+    TimerHandle alarmTimer;
+    const int* alarmNotes;    // PROGMEM melody played by alarmTimer
+    const int* alarmDurations;
+    uint8_t alarmCount;
     
     // Helper methods
-    void updateLightShow();
-    void handleSchedules();
-    void checkAlarms();
+    bool driveServo(Servo& servo, ServoMotion& motion, int& written, unsigned long now);
+    void driveFan(unsigned long now);
+    void requestIntent(IntentTarget target, int value);
+    int appliedValue(IntentTarget target);
+    void applyIntent(IntentTarget target, int value);
+    void applyFan(FanSpeed speed);
+    void applyWindowOpening(int percentage);
+    void applyDoorState(DoorState state);
+    void applyLightMode(LightMode mode);
+    void applyLight(int brightness);
+    void replaceSchedule(TimerHandle* handles, int startHour, int endHour, uint16_t startAction,
+                         uint16_t endAction);
+    static void scheduledAction(void* context, uint16_t action);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "adaptive_sampler.h"
+
+static const float VOLATILITY_WEIGHT = 0.3;
+static const float ACTIVE_VOLATILITY = 0.25;   // RMS change above half a deadband
+static const float STABLE_VOLATILITY = 0.04;   // RMS change below a fifth
+static const float BACKOFF_FACTOR = 1.5;
+
+AdaptiveSampler::AdaptiveSampler(unsigned long minInterval, unsigned long baseInterval,
+                                 unsigned long maxInterval)
+    : minInterval(minInterval), baseInterval(max(baseInterval, minInterval)),
+      maxInterval(max(maxInterval, this->baseInterval)), current(this->baseInterval), adaptive(true),
+      volatility(0.0), averageInterval(this->baseInterval), startTime(0), lastSample(0), count(0) {
+}
+
+unsigned long AdaptiveSampler::update(float change, unsigned long now) {
+    if (count == 0) {
+        startTime = now;
+    } else {
+        averageInterval += 0.2 * ((float)(now - lastSample) - averageInterval);
+    }
+    lastSample = now;
+    count++;
+
+    if (!adaptive) {
+        current = constrain(baseInterval, minInterval, maxInterval);
+        return current;
+    }
+
+    volatility += VOLATILITY_WEIGHT * (change * change - volatility);
+    if (change >= 1.0) {
+        // A significant step: follow it at full rate straight away
+        current = minInterval;
+    } else if (volatility > ACTIVE_VOLATILITY) {
+        current = max(current / 2, minInterval);
+    } else if (volatility < STABLE_VOLATILITY) {
+        current = min((unsigned long)(current * BACKOFF_FACTOR), maxInterval);
+    }
+    return current;
+}
+
+void AdaptiveSampler::setMaxInterval(unsigned long interval) {
+    maxInterval = max(interval, minInterval);
+    current = min(current, maxInterval);
+}
+
+void AdaptiveSampler::setAdaptive(bool enabled) {
+    adaptive = enabled;
+    // Fixed rate still honours a tightened ceiling from setMaxInterval()
+    if (!enabled) current = constrain(baseInterval, minInterval, maxInterval);
+}
+
+unsigned long AdaptiveSampler::interval() const {
+    return current;
+}
+
+unsigned long AdaptiveSampler::minimumInterval() const {
+    return minInterval;
+}
+
+float AdaptiveSampler::effectiveRate() const {
+    return count > 1 ? 1000.0 / averageInterval : 1000.0 / current;
+}
+
+unsigned long AdaptiveSampler::samples() const {
+    return count;
+}
+
+long AdaptiveSampler::samplesSaved(unsigned long now) const {
+    // Negative while sampling faster than the base cadence
+    if (count == 0) return 0;
+    unsigned long baseline = (now - startTime) / baseInterval + 1;
+    return (long)baseline - (long)count;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <Arduino.h>
+
+// Picks the polling interval of one sensor from how much its readings move.
+// Changes are given in units of the channel's significance (its deadband):
+// a significant step jumps to the fastest rate, sustained volatility halves
+// the interval and a stable channel backs off exponentially. The interval
+// never drops below the hardware minimum.
+class AdaptiveSampler {
+public:
+    AdaptiveSampler(unsigned long minInterval = 1000, unsigned long baseInterval = 1000,
+                    unsigned long maxInterval = 60000);
+
+    // Record a successful sample, returns the interval until the next one
+    unsigned long update(float change, unsigned long now);
+    void setMaxInterval(unsigned long interval);
+    void setAdaptive(bool enabled);
+
+    unsigned long interval() const;
+    unsigned long minimumInterval() const;
+    float effectiveRate() const;                 // Samples per second
+    unsigned long samples() const;
+    long samplesSaved(unsigned long now) const;  // Versus the fixed base cadence
+
+private:
+    unsigned long minInterval;
+    unsigned long baseInterval;
+    unsigned long maxInterval;
+    unsigned long current;
+    bool adaptive;
+
+    float volatility;           // EWMA of the squared normalized change
+    float averageInterval;
+    unsigned long startTime;
+    unsigned long lastSample;
+    unsigned long count;
+};
+
+#endif
\ No newline at end of file
@@ -6,7 +6,8 @@ Automation::Automation()
       moistureThreshold(40.0), targetTemperature(23.0), targetHumidity(50.0),
       comfortIndex(0.0), baselineConsumption(1000.0), rainExpected(false),
       forecastTemperature(0.0), learningEnabled(true), adaptiveMode(true),
-      lastOptimization(0), optimizationInterval(3600000) { // 1 hour
+      lastOptimization(0), optimizationInterval(3600000), // 1 hour
+      ruleSequence(0), lastValidFields(0), lastRuleRefresh(0), ruleEvaluations(0) {
     
     // Initialize energy stats
     energyStats = {0.0, 0.0, 0.0, 0.0, 0.0};
@@ -17,6 +18,21 @@ Automation::Automation()
         lightingPreferences[i] = 200;
         activityPatterns[i] = 0;
     }
+    
+    // Fields each handler reads; time-based work runs on the refresh interval
+    subscriptions[HANDLER_CLIMATE] = FIELD_BIT(FIELD_TEMPERATURE) | FIELD_BIT(FIELD_HUMIDITY) |
+        FIELD_BIT(FIELD_CO2) | FIELD_BIT(FIELD_RAIN) | FIELD_BIT(FIELD_PREDICTED_TEMPERATURE);
+    subscriptions[HANDLER_GARDEN] = FIELD_BIT(FIELD_SOIL_MOISTURE) | FIELD_BIT(FIELD_UV) |
+        FIELD_BIT(FIELD_TEMPERATURE) | FIELD_BIT(FIELD_HUMIDITY);
+    subscriptions[HANDLER_ENERGY] = 0;
+    subscriptions[HANDLER_SECURITY] = FIELD_BIT(FIELD_MOTION) | FIELD_BIT(FIELD_LIGHT) |
+        FIELD_BIT(FIELD_AIR_QUALITY) | FIELD_BIT(FIELD_GAS);
+    subscriptions[HANDLER_COMFORT] = FIELD_BIT(FIELD_TEMPERATURE) | FIELD_BIT(FIELD_HUMIDITY) |
+        FIELD_BIT(FIELD_AIR_QUALITY) | FIELD_BIT(FIELD_LIGHT) | FIELD_BIT(FIELD_NOISE);
+    refreshInterval = 60000;
+    for (int i = 0; i < HANDLER_COUNT; i++) {
+        handlerLastRun[i] = 0;
+    }
 }
 
 void Automation::begin() {
@@ -30,23 +46,31 @@ void Automation::handleClimateControl(const SensorData& data, const WeatherData&
     float predictedTemp = mlModel.predictTemperature(data, forecast);
     float optimalTemp = calculateOptimalTemperature(data.temperature, forecast);
     
+    // Pre-condition: when the room is forecast to drift further from the
+    // optimum within the look-ahead, act on the forecast instead of waiting
+    float controlTemp = data.temperature;
+    if ((data.validFields & (1UL << FIELD_PREDICTED_TEMPERATURE)) &&
+        abs(data.predictedTemperature - optimalTemp) > abs(data.temperature - optimalTemp)) {
+        controlTemp = data.predictedTemperature;
+    }
+    
     // Advanced thermal management
-    if (abs(data.temperature - optimalTemp) > 0.5) {
-        if (data.temperature < optimalTemp) {
-            if (forecast.temperature > data.temperature + 2) {
+    if (abs(controlTemp - optimalTemp) > 0.5) {
+        if (controlTemp < optimalTemp) {
+            if (forecast.temperature > controlTemp + 2) {
                 // Natural heating possible
                 actuators.setWindowOpening(calculateOptimalOpening(data, forecast));
                 actuators.setFan(LOW);
             } else {
-                activateHeating(optimalTemp - data.temperature);
+                activateHeating(optimalTemp - controlTemp);
             }
         } else {
-            if (forecast.temperature < data.temperature - 2) {
+            if (forecast.temperature < controlTemp - 2) {
                 // Natural cooling possible
                 actuators.setWindowOpening(calculateOptimalOpening(data, forecast));
                 actuators.setFan(MEDIUM);
             } else {
-                activateCooling(data.temperature - optimalTemp);
+                activateCooling(controlTemp - optimalTemp);
             }
         }
     }
@@ -68,6 +92,43 @@ void Automation::handleClimateControl(const SensorData& data, const WeatherData&
     }
 }
 
+bool Automation::isHandlerDue(AutomationHandler handler, const SensorData& data) {
+    // Steady state idles the handler until the refresh interval runs out
+    bool changed = (data.changedFields & subscriptions[handler]) != 0;
+    bool stale = handlerLastRun[handler] == 0 || data.timestamp - handlerLastRun[handler] >= refreshInterval;
+    if (!changed && !stale) return false;
+    
+    handlerLastRun[handler] = data.timestamp;
+    return true;
+}
+
+void Automation::subscribe(AutomationHandler handler, uint32_t fieldMask) {
+    subscriptions[handler] = fieldMask;
+}
+
+void Automation::setRefreshInterval(unsigned long interval) {
+    refreshInterval = interval;
+}
+
+TimerHandle Automation::addScheduledTask(const String& name, int hour, int minute, TimerCallback callback,
+                                         void* context, uint16_t arg) {
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return 0;
+    TimerHandle handle = timers.scheduleDaily(hour, minute, callback, context, arg);
+    if (!handle) {
+        Serial.print(F("No timer left for "));
+        Serial.println(name);
+    }
+    return handle;
+}
+
+void Automation::cancelScheduledTask(TimerHandle handle) {
+    timers.cancel(handle);
+}
+
+int Automation::getCurrentHour() const {
+    return timers.isClockSet() ? timers.hour() : -1;
+}
+
 void Automation::handleGardenCare(const SensorData& data, const WeatherData& forecast) {
     // Smart irrigation with soil analysis
     if (data.soilMoisture < moistureThreshold) {
@@ -131,14 +192,11 @@ void Automation::handleEnergyManagement(const SensorData& data) {
 void Automation::handleSecurity(const SensorData& data) {
     static unsigned long lastMotion = 0;
     static int motionCount = 0;
-    static std::vector<SecurityEvent> securityLog;
     
     // Advanced motion analysis
     if (data.motion) {
         SecurityEvent event = {millis(), data.motion, data.lightLevel};
-        securityLog.push_back(event);
-        
-        if (analyzeMotionPattern(securityLog)) {
+        if (analyzeMotionPattern(event)) {
             handleSuspiciousActivity();
         }
         
@@ -153,8 +211,10 @@ void Automation::handleSecurity(const SensorData& data) {
         activateSecurityResponse();
     }
     
-    // Environmental hazard detection
-    if (data.airQuality < 30 || data.gasLevel > 100) {
+    // Environmental hazard detection, a single-sample outlier the sensor
+    // layer has not confirmed yet is not enough to raise the alarm
+    const uint32_t airFields = (1UL << FIELD_AIR_QUALITY) | (1UL << FIELD_GAS);
+    if ((data.airQuality < 30 || data.gasLevel > 100) && !(data.suspectFields & airFields)) {
         handleEmergency("ENVIRONMENTAL");
     }
     
@@ -167,6 +227,15 @@ void Automation::handleSecurity(const SensorData& data) {
     }
 }
 
+bool Automation::analyzeMotionPattern(const SecurityEvent& event) {
+    // Bounded log with per-location counters, constant work per event
+    return securityMonitor.record(event);
+}
+
+void Automation::printSecurityStats(Print& out) const {
+    securityMonitor.printStats(out);
+}
+
 void Automation::optimizeComfort(const SensorData& data) {
     // Multi-factor comfort analysis
     ComfortFactors factors;
@@ -293,6 +362,10 @@ void Automation::adjustClimateControl(float temperature, float humidity) {
     }
 }
 
+float Automation::calculateDewPoint(float temperature, float humidity) {
+    return Psychrometrics::dewPoint(temperature, humidity);
+}
+
 void Automation::calculateEnergySavings() {
     float currentUsage = energyStats.currentConsumption;
     float savings = ((baselineConsumption - currentUsage) / baselineConsumption) * 100;
@@ -316,37 +389,224 @@ void Automation::handleEmergency(const String& type) {
     }
 }
 
-void Automation::addAutomationRule(const AutomationRule& rule) {
-    rules.push_back(rule);
-    std::sort(rules.begin(), rules.end(), 
-              [](const AutomationRule& a, const AutomationRule& b) {
-                  return a.priority > b.priority;
-              });
+RuleId Automation::addAutomationRule(const AutomationRule& rule) {
+    // Parse once here so evaluation never touches the rule text
+    AutomationRule compiled = rule;
+    if (!RuleEngine::compileCondition(rule.condition.c_str(), compiled.program)) {
+        Serial.print(F("Invalid rule condition: "));
+        Serial.println(rule.condition);
+        return 0;
+    }
+    if (!RuleEngine::compileActions(rule.action.c_str(), compiled.program)) {
+        Serial.print(F("Invalid rule action: "));
+        Serial.println(rule.action);
+        return 0;
+    }
+    
+    // Reuse a free slot, its generation makes old ids for it stale
+    uint16_t slot;
+    uint16_t generation = 0;
+    if (!freeRuleSlots.empty()) {
+        slot = freeRuleSlots.back();
+        freeRuleSlots.pop_back();
+        generation = (rules[slot].id >> 16) + 1;
+    } else if (rules.size() < 0xFFFF) {
+        slot = rules.size();
+        rules.push_back(compiled);
+    } else {
+        return 0;
+    }
+    
+    compiled.id = ((RuleId)generation << 16) | (slot + 1);
+    compiled.sequence = ruleSequence++;
+    compiled.active = false;
+    compiled.pending = true;        // Evaluated on the next pass
+    rules[slot] = compiled;
+    
+    ruleOrder.insert(ruleKey(slot));
+    pendingRules.push_back(slot);
+    for (int f = 0; f < SENSOR_FIELD_COUNT; f++) {
+        if (compiled.program.fieldMask & FIELD_BIT(f)) fieldRules[f].push_back(slot);
+    }
+    return compiled.id;
+}
+
+int Automation::importAutomationRules(const AutomationRule* list, int count) {
+    rules.reserve(rules.size() + count);
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        if (addAutomationRule(list[i])) added++;
+    }
+    return added;
+}
+
+bool Automation::removeAutomationRule(RuleId id) {
+    int slot = findRuleSlot(id);
+    if (slot < 0) return false;
+    
+    AutomationRule& rule = rules[slot];
+    RuleKey key = ruleKey(slot);
+    ruleOrder.erase(key);
+    if (rule.active) activeRules.erase(key);
+    if (rule.pending) {
+        pendingRules.erase(std::find(pendingRules.begin(), pendingRules.end(), slot));
+    }
+    for (int f = 0; f < SENSOR_FIELD_COUNT; f++) {
+        if (!(rule.program.fieldMask & FIELD_BIT(f))) continue;
+        std::vector<uint16_t>& list = fieldRules[f];
+        std::vector<uint16_t>::iterator it = std::find(list.begin(), list.end(), slot);
+        *it = list.back();
+        list.pop_back();
+    }
+    
+    // Keep the generation, clear the slot bits and release the text
+    rule.id &= 0xFFFF0000UL;
+    rule.condition = String();
+    rule.action = String();
+    rule.active = false;
+    rule.pending = false;
+    freeRuleSlots.push_back(slot);
+    return true;
 }
 
-void Automation::removeAutomationRule(const String& condition) {
-    rules.erase(
-        std::remove_if(rules.begin(), rules.end(),
-                      [&](const AutomationRule& rule) {
-                          return rule.condition == condition;
-                      }),
-        rules.end());
+bool Automation::setRuleEnabled(RuleId id, bool enabled) {
+    // Disabled rules are still evaluated so they resume with a current result
+    int slot = findRuleSlot(id);
+    if (slot < 0) return false;
+    rules[slot].enabled = enabled;
+    return true;
 }
 
-void Automation::processAutomationRules() {
+const AutomationRule* Automation::getAutomationRule(RuleId id) const {
+    int slot = findRuleSlot(id);
+    return slot < 0 ? NULL : &rules[slot];
+}
+
+size_t Automation::getRuleCount() const {
+    return ruleOrder.size();
+}
+
+void Automation::printAutomationRules(Print& out) const {
+    // Priority order, as the rules fire
+    for (const RuleKey& key : ruleOrder) {
+        const AutomationRule& rule = rules[key.slot];
+        out.print(rule.id, HEX);
+        out.print(F(" p"));
+        out.print(rule.priority);
+        out.print(rule.enabled ? F(" on ") : F(" off "));
+        out.print(rule.active ? F("true: ") : F("false: "));
+        out.print(rule.condition);
+        out.print(F(" -> "));
+        out.println(rule.action);
+    }
+}
+
+int Automation::findRuleSlot(RuleId id) const {
+    int slot = (int)(id & 0xFFFF) - 1;
+    if (slot < 0 || slot >= (int)rules.size() || rules[slot].id != id) return -1;
+    return slot;
+}
+
+RuleKey Automation::ruleKey(uint16_t slot) const {
+    RuleKey key = {rules[slot].priority, rules[slot].sequence, slot};
+    return key;
+}
+
+void Automation::updateRule(uint16_t slot, const float* fields, uint32_t validFields) {
+    AutomationRule& rule = rules[slot];
+    bool result = RuleEngine::evaluate(rule.program, fields, validFields);
+    ruleEvaluations++;
+    if (result == rule.active) return;
+    
+    rule.active = result;
+    if (result) {
+        activeRules.insert(ruleKey(slot));
+    } else {
+        activeRules.erase(ruleKey(slot));
+    }
+}
+
+void Automation::processAutomationRules(const SensorData& data) {
+    // Field slots the compiled conditions index, invalid fields are
+    // unknown to the rule engine
+    float fields[SENSOR_FIELD_COUNT];
+    for (int i = 0; i < SENSOR_FIELD_COUNT; i++) {
+        fields[i] = (data.validFields & FIELD_BIT(i)) ?
+            sensors.getFieldValue(data, (SensorField)i) : NAN;
+    }
+    
+    // Changes inside a field's deadband are not reported, so everything is
+    // re-evaluated on the handler refresh interval as well
+    if (data.timestamp - lastRuleRefresh >= refreshInterval) {
+        lastRuleRefresh = data.timestamp;
+        for (const RuleKey& key : ruleOrder) {
+            updateRule(key.slot, fields, data.validFields);
+        }
+    } else {
+        // A field also counts as changed when it becomes valid or invalid
+        uint32_t changed = data.changedFields | (data.validFields ^ lastValidFields);
+        for (int f = 0; changed; f++, changed >>= 1) {
+            if (!(changed & 1)) continue;
+            for (uint16_t slot : fieldRules[f]) {
+                if (rules[slot].pending) continue;
+                rules[slot].pending = true;
+                pendingRules.push_back(slot);
+            }
+        }
+        for (uint16_t slot : pendingRules) {
+            updateRule(slot, fields, data.validFields);
+        }
+    }
+    for (uint16_t slot : pendingRules) {
+        rules[slot].pending = false;
+    }
+    pendingRules.clear();
+    lastValidFields = data.validFields;
+    // True rules fire in priority order, at most once a minute each
     unsigned long currentTime = millis();
-    for (auto& rule : rules) {
+    for (const RuleKey& key : activeRules) {
+        AutomationRule& rule = rules[key.slot];
         if (!rule.enabled) continue;
         
-        if (evaluateCondition(rule.condition)) {
-            if (currentTime - rule.lastTriggered > 60000) { // 1-minute minimum interval
-                executeAction(rule.action);
-                rule.lastTriggered = currentTime;
+        if (currentTime - rule.lastTriggered > 60000) { // 1-minute minimum interval
+            for (uint8_t i = 0; i < rule.program.actionCount; i++) {
+                executeAction(rule.program.actions[i]);
             }
+            rule.lastTriggered = currentTime;
         }
     }
 }
 
+unsigned long Automation::getRuleEvaluations() const {
+    return ruleEvaluations;
+}
+
+void Automation::executeAction(const RuleAction& action) {
+    switch (action.target) {
+        case RULE_ACTION_FAN:
+            actuators.setFan((FanSpeed)action.value);
+            break;
+        case RULE_ACTION_WINDOW:
+            actuators.setWindowOpening(action.value);
+            break;
+        case RULE_ACTION_DOOR:
+            actuators.setDoorState((DoorState)action.value);
+            break;
+        case RULE_ACTION_LIGHT:
+            actuators.setLight(action.value);
+            break;
+        case RULE_ACTION_LIGHT_MODE:
+            actuators.setLightMode((LightMode)action.value);
+            break;
+        case RULE_ACTION_ALARM:
+            actuators.triggerAlarm();
+            break;
+        case RULE_ACTION_BUZZER:
+            actuators.triggerBuzzer(action.value > 1 ? action.value : 1000);
+            break;
+    }
+}
+
 void Automation::optimizeEnergyUsage(bool enableML) {
     if (enableML) {
         // Use machine learning to predict optimal settings
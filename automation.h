@@ -3,8 +3,12 @@
 
 #include <Arduino.h>
 #include <vector>
+#include <set>
 #include "sensors.h"
 #include "actuators.h"
+#include "psychrometrics.h"
+#include "rule_engine.h"
+#include "security_monitor.h"
 
 enum CommandType {
     NONE,
@@ -46,14 +50,6 @@ struct EnergyStats {
     float renewableUsage;
 };
 
-struct SecurityEvent {
-    unsigned long timestamp;
-    bool motion;
-    float lightLevel;
-    String location;
-    int severity;
-};
-
 struct ComfortFactors {
     float temperature;
     float humidity;
@@ -63,12 +59,34 @@ struct ComfortFactors {
     float pressure;
 };
 
+// Rule slot plus a generation count, so a stale id never removes a rule
+// that later took over the slot; 0 is never a valid id
+typedef uint32_t RuleId;
+
 struct AutomationRule {
     String condition;
     String action;
     bool enabled;
     unsigned long lastTriggered;
     int priority;
+    // Filled in by addAutomationRule()
+    RuleProgram program;
+    RuleId id;                  // Slot bits are 0 while the slot is free
+    uint32_t sequence;          // Insertion order, breaks priority ties
+    bool active;                // Condition result at the last evaluation
+    bool pending;               // Queued for re-evaluation
+};
+
+// Position in the priority index: higher priority first, then older rules
+struct RuleKey {
+    int priority;
+    uint32_t sequence;
+    uint16_t slot;
+    
+    bool operator<(const RuleKey& other) const {
+        if (priority != other.priority) return priority > other.priority;
+        return sequence < other.sequence;
+    }
 };
 
 // New structures for enhanced functionality
@@ -103,6 +121,16 @@ struct OccupancyPattern {
     unsigned long lastUpdate;
 };
 
+// Handlers dispatched by the main loop, see Automation::isHandlerDue()
+enum AutomationHandler {
+    HANDLER_CLIMATE,
+    HANDLER_GARDEN,
+    HANDLER_ENERGY,
+    HANDLER_SECURITY,
+    HANDLER_COMFORT,
+    HANDLER_COUNT
+};
+
 class Automation {
 public:
     Automation();
@@ -115,6 +143,12 @@ public:
     void handleSecurity(const SensorData& data);
     void optimizeComfort(const SensorData& data);
     
+    // Change-driven dispatch: a handler is due when one of its subscribed
+    // fields changed, or when its refresh interval has passed
+    bool isHandlerDue(AutomationHandler handler, const SensorData& data);
+    void subscribe(AutomationHandler handler, uint32_t fieldMask);
+    void setRefreshInterval(unsigned long interval);
+    
     // Mode management
     void setMode(const String& mode, bool enabled);
     void setThresholds(const SystemSettings::thresholds& newThresholds);
@@ -122,6 +156,11 @@ public:
     // Schedule management
     void updateSchedule(const String& device, const Schedule& schedule);
     void checkSchedules();
+    // Daily task on the shared timer wheel, returns 0 when the pool is full
+    TimerHandle addScheduledTask(const String& name, int hour, int minute, TimerCallback callback,
+                                 void* context = NULL, uint16_t arg = 0);
+    void cancelScheduledTask(TimerHandle handle);
+    int getCurrentHour() const;     // -1 until the wall clock has been set
     
     // Weather adaptation
     void updateWeatherStrategy(const WeatherData& forecast);
@@ -134,9 +173,17 @@ public:
     float getComfortIndex() const;
     
     // Advanced Features
-    void addAutomationRule(const AutomationRule& rule);
-    void removeAutomationRule(const String& condition);
-    void processAutomationRules();
+    // Compiles the rule's condition and actions, returns 0 if either is invalid
+    RuleId addAutomationRule(const AutomationRule& rule);
+    int importAutomationRules(const AutomationRule* list, int count);   // Returns the number added
+    bool removeAutomationRule(RuleId id);
+    bool setRuleEnabled(RuleId id, bool enabled);
+    const AutomationRule* getAutomationRule(RuleId id) const;
+    size_t getRuleCount() const;
+    void printAutomationRules(Print& out) const;
+    // Re-evaluates only the rules that read a field that changed since the last call
+    void processAutomationRules(const SensorData& data);
+    unsigned long getRuleEvaluations() const;
     void optimizeEnergyUsage(bool enableML = true);
     void analyzeBehaviorPatterns();
     void predictMaintenanceNeeds();
@@ -147,6 +194,7 @@ public:
     void manageLoadBalancing();
     void optimizeHVACSchedule();
     String getSecurityStatus() const;
+    void printSecurityStats(Print& out) const;
     void notifyAuthorities();
     void evacuationProtocol();
 
@@ -184,6 +232,11 @@ public:
     void handleSecurityBreach(const String& location);
 
 private:
+    // Handler subscriptions (SensorField bits) and last run times
+    uint32_t subscriptions[HANDLER_COUNT];
+    unsigned long handlerLastRun[HANDLER_COUNT];
+    unsigned long refreshInterval;
+    
     // System states
     bool nightMode;
     bool vacationMode;
@@ -218,12 +271,27 @@ private:
     unsigned long lastOptimization;
     unsigned long optimizationInterval;
     unsigned long lastSecurityCheck;
+    SecurityMonitor securityMonitor;
     
-    // Automation rules
+    // Automation rules by slot (see RuleId), the priority index over all of
+    // them and over the currently true ones, and the slots reading each field
     std::vector<AutomationRule> rules;
+    std::vector<uint16_t> freeRuleSlots;
+    std::set<RuleKey> ruleOrder;
+    std::set<RuleKey> activeRules;
+    std::vector<uint16_t> fieldRules[SENSOR_FIELD_COUNT];
+    std::vector<uint16_t> pendingRules;
+    uint32_t ruleSequence;
+    uint32_t lastValidFields;
+    unsigned long lastRuleRefresh;
+    unsigned long ruleEvaluations;
     
     // Helper methods
     void adjustClimateControl(float temperature, float humidity);
+    void executeAction(const RuleAction& action);
+    int findRuleSlot(RuleId id) const;
+    RuleKey ruleKey(uint16_t slot) const;
+    void updateRule(uint16_t slot, const float* fields, uint32_t validFields);
     void calculateEnergySavings();
     void handleEmergency(const String& type);
     void loadUserPreferences();
@@ -242,7 +310,7 @@ private:
     void updateBaselineConsumption();
     void updateEnergyStats(float consumption);
     void predictFutureConsumption();
-    bool analyzeMotionPattern(const std::vector<SecurityEvent>& events);
+    bool analyzeMotionPattern(const SecurityEvent& event);
     void handleSuspiciousActivity();
     bool checkPerimeterBreach(const SensorData& data);
     void activateSecurityResponse();
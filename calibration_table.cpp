@@ -0,0 +1,50 @@
+#include "calibration_table.h"
+
+CalibrationTable::CalibrationTable() : count(0) {
+}
+
+void CalibrationTable::clear() {
+    count = 0;
+}
+
+bool CalibrationTable::addPoint(int16_t raw, int16_t value) {
+    if (count == MAX_POINTS) return false;
+    if (count > 0 && raw <= raws[count - 1]) return false;
+    raws[count] = raw;
+    values[count] = value;
+    count++;
+    return true;
+}
+
+int16_t CalibrationTable::apply(int16_t raw) const {
+    if (count == 0) return 0;
+    if (raw <= raws[0]) return values[0];
+    if (raw >= raws[count - 1]) return values[count - 1];
+    
+    // Narrow down to the segment raws[low] <= raw < raws[high]
+    uint8_t low = 0;
+    uint8_t high = count - 1;
+    while (high - low > 1) {
+        uint8_t middle = (low + high) / 2;
+        if (raws[middle] <= raw) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    
+    int32_t rise = (int32_t)values[high] - values[low];
+    return values[low] + (int16_t)(rise * (raw - raws[low]) / (raws[high] - raws[low]));
+}
+
+uint8_t CalibrationTable::size() const {
+    return count;
+}
+
+int16_t CalibrationTable::rawAt(uint8_t index) const {
+    return index < count ? raws[index] : 0;
+}
+
+int16_t CalibrationTable::valueAt(uint8_t index) const {
+    return index < count ? values[index] : 0;
+}
\ No newline at end of file
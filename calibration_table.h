@@ -0,0 +1,33 @@
+#ifndef CALIBRATION_TABLE_H
+#define CALIBRATION_TABLE_H
+
+#include <Arduino.h>
+
+// Piecewise-linear map from a raw ADC count to a calibrated value in fixed
+// units (ppm, hundredths of an index, ...). Breakpoints are kept sorted by
+// raw count, so a lookup is a short binary search plus one integer
+// interpolation; nonlinear sensor curves are sampled into the table once
+// at calibration time instead of evaluated on every reading.
+class CalibrationTable {
+public:
+    static const uint8_t MAX_POINTS = 12;
+
+    CalibrationTable();
+
+    void clear();
+    // Raw counts must increase, points that do not are dropped
+    bool addPoint(int16_t raw, int16_t value);
+    // Interpolated value, clamped to the end points outside the table
+    int16_t apply(int16_t raw) const;
+
+    uint8_t size() const;
+    int16_t rawAt(uint8_t index) const;
+    int16_t valueAt(uint8_t index) const;
+
+private:
+    int16_t raws[MAX_POINTS];
+    int16_t values[MAX_POINTS];
+    uint8_t count;
+};
+
+#endif
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "display.h"
 
+// SSD1306 I2C address and the command that resets the write window to the
+// whole panel, led by the command-stream control byte
+static const uint8_t SSD1306_ADDRESS = 0x3C;
+static const uint8_t FRAME_HEADER[] = {0x00, 0x22, 0x00, 0xFF, 0x21, 0x00, 0x7F};
+
 Display::Display() 
     : display(128, 64, &Wire, -1), 
       detailedMode(false),
@@ -7,10 +12,11 @@ Display::Display()
       autoPageChange(false),
       pageChangeInterval(5000),
       lastPageChange(0) {
+    frameTransfer.status = I2C_IDLE;
 }
 
 bool Display::begin() {
-    if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
+    if (!display.begin(SSD1306_SWITCHCAPVCC, SSD1306_ADDRESS)) {
         return false;
     }
     display.display();
@@ -48,7 +54,7 @@ void Display::updateStatus(float temperature, float humidity, bool motion, float
             break;
     }
     
-    display.display();
+    flush();
     
     // Handle auto page change
     if (autoPageChange && (millis() - lastPageChange >= pageChangeInterval)) {
@@ -86,7 +92,7 @@ void Display::showEnergyStats(float consumption, float solar, float battery) {
     display.print(battery);
     display.println("%");
     
-    display.display();
+    flush();
 }
 
 void Display::showSecurityStatus(bool doorLocked, bool windowsClosed, bool motionDetected) {
@@ -109,7 +115,7 @@ void Display::showSecurityStatus(bool doorLocked, bool windowsClosed, bool motio
     display.print("Motion: ");
     display.println(motionDetected ? "DETECTED" : "NONE");
     
-    display.display();
+    flush();
 }
 
 void Display::showWeatherForecast(float tempTrend, float humidityTrend, float pressureTrend) {
@@ -135,7 +141,65 @@ void Display::showWeatherForecast(float tempTrend, float humidityTrend, float pr
     display.print("Pressure: ");
     drawTrendIndicator(50, 36, pressureTrend);
     
-    display.display();
+    flush();
+}
+
+void Display::showGraph(float data[], int count, const char* title) {
+    display.clearDisplay();
+    display.setTextSize(1);
+    display.setTextColor(WHITE);
+    
+    display.setCursor(0, 0);
+    display.println(title);
+    if (count < 2) {
+        flush();
+        return;
+    }
+    
+    // Scale the series into the plot area below the title
+    float minValue = data[0];
+    float maxValue = data[0];
+    for (int i = 1; i < count; i++) {
+        if (data[i] < minValue) minValue = data[i];
+        if (data[i] > maxValue) maxValue = data[i];
+    }
+    float range = maxValue - minValue;
+    if (range < 0.1) range = 0.1;
+    
+    const int top = 12;
+    const int height = 52;
+    int prevX = 0;
+    int prevY = top + height - 1 - (int)((data[0] - minValue) / range * (height - 1));
+    for (int i = 1; i < count; i++) {
+        int x = (long)i * 127 / (count - 1);
+        int y = top + height - 1 - (int)((data[i] - minValue) / range * (height - 1));
+        display.drawLine(prevX, prevY, x, y, WHITE);
+        prevX = x;
+        prevY = y;
+    }
+    
+    flush();
+}
+
+void Display::showHistory(const SensorHistory& history, HistoryResolution resolution, const char* title) {
+    // Graph straight from the rollup tier, no extra sampling needed
+    float points[SensorHistory::MINUTE_SIZE];
+    int count = history.copyMeans(resolution, points, SensorHistory::MINUTE_SIZE);
+    showGraph(points, count, title);
+}
+
+void Display::flush() {
+    // Queue the frame for the bus arbiter, which sends it in chunks between
+    // sensor transfers. A frame still in flight restarts with the new content.
+    i2cBus.cancel(frameTransfer);
+    frameTransfer.address = SSD1306_ADDRESS;
+    frameTransfer.priority = I2C_PRIORITY_LOW;
+    frameTransfer.header = FRAME_HEADER;
+    frameTransfer.headerLength = sizeof(FRAME_HEADER);
+    frameTransfer.data = display.getBuffer();
+    frameTransfer.length = display.width() * ((display.height() + 7) / 8);
+    frameTransfer.prefix = 0x40;   // Data-stream control byte
+    i2cBus.submit(frameTransfer);
 }
 
 void Display::nextPage() {
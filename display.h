@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <Adafruit_SSD1306.h>
 #include <Wire.h>
+#include "sensor_history.h"
+#include "i2c_bus.h"
 
 enum DisplayPage {
     MAIN,
@@ -22,6 +24,7 @@ public:
     void updateStatus(float temperature, float humidity, bool motion, float lightLevel, bool isRaining, float airQuality);
     void showAlert(const char* message);
     void showGraph(float data[], int count, const char* title);
+    void showHistory(const SensorHistory& history, HistoryResolution resolution, const char* title);
     void showEnergyStats(float consumption, float solar, float battery);
     void showSecurityStatus(bool doorLocked, bool windowsClosed, bool motionDetected);
     void showWeatherForecast(float tempTrend, float humidityTrend, float pressureTrend);
@@ -41,8 +44,10 @@ private:
     bool autoPageChange;
     unsigned long pageChangeInterval;
     unsigned long lastPageChange;
+    I2CTransaction frameTransfer;
     
     // Helper methods
+    void flush();
     void drawProgressBar(int x, int y, int width, int height, int progress);
     void displayBasicInfo(float temperature, float humidity, bool motion, float lightLevel);
     void displayDetailedInfo(float temperature, float humidity, bool motion, float lightLevel, bool isRaining, float airQuality);
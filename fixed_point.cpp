@@ -0,0 +1,86 @@
+#include "fixed_point.h"
+
+// ln(1 + i/16) for i = 0..16, in Q16.16
+static const fix16_t LOG_TABLE[17] PROGMEM = {
+    0, 3973, 7719, 11262, 14624, 17821, 20870, 23783, 26573,
+    29248, 31818, 34292, 36675, 38975, 41196, 43345, 45426
+};
+
+static const fix16_t FIX16_LN2 = 45426;
+
+static fix16_t readTable(const fix16_t* table, int index) {
+#if defined(__AVR__)
+    return (fix16_t)pgm_read_dword(&table[index]);
+#else
+    return table[index];
+#endif
+}
+
+static fix16_t interpolate(const fix16_t* table, fix16_t fraction) {
+    // fraction is in [0, 1): top 4 bits pick the segment, low 12 bits blend
+    int index = fraction >> 12;
+    int32_t blend = fraction & 0x0FFF;
+    fix16_t start = readTable(table, index);
+    fix16_t end = readTable(table, index + 1);
+    return start + (((end - start) * blend) >> 12);
+}
+
+fix16_t fix16Log(fix16_t x) {
+    if (x <= 0) return FIX16_MIN;
+
+    // Normalize x = m * 2^e with m in [1, 2)
+    int exponent = 0;
+    while (x >= 2 * FIX16_ONE) {
+        x >>= 1;
+        exponent++;
+    }
+    while (x < FIX16_ONE) {
+        x <<= 1;
+        exponent--;
+    }
+
+    return exponent * FIX16_LN2 + interpolate(LOG_TABLE, x - FIX16_ONE);
+}
+
+fix16_t fix16Div(fix16_t a, fix16_t b) {
+    if (b == 0) return a >= 0 ? FIX16_MAX : FIX16_MIN;
+#if defined(__AVR__)
+    // Shift-and-subtract long division on 32-bit magnitudes, one quotient
+    // bit per step, so no 64-bit divide helper is pulled in
+    uint32_t remainder = a >= 0 ? (uint32_t)a : -(uint32_t)a;
+    uint32_t divider = b >= 0 ? (uint32_t)b : -(uint32_t)b;
+    uint32_t quotient = 0;
+    uint32_t bit = 0x10000;
+
+    // Align the divider with the remainder
+    while (divider < remainder) {
+        divider <<= 1;
+        bit <<= 1;
+    }
+    if (!bit) return (a ^ b) >= 0 ? FIX16_MAX : FIX16_MIN;
+    if (divider & 0x80000000UL) {
+        if (remainder >= divider) {
+            quotient |= bit;
+            remainder -= divider;
+        }
+        divider >>= 1;
+        bit >>= 1;
+    }
+
+    // Shift the remainder instead of the divider to keep every bit
+    while (bit && remainder) {
+        if (remainder >= divider) {
+            quotient |= bit;
+            remainder -= divider;
+        }
+        remainder <<= 1;
+        bit >>= 1;
+    }
+    if (remainder >= divider) quotient++;  // Round the last bit
+
+    if (quotient > (uint32_t)FIX16_MAX) return (a ^ b) >= 0 ? FIX16_MAX : FIX16_MIN;
+    return (a ^ b) < 0 ? -(fix16_t)quotient : (fix16_t)quotient;
+#else
+    return (fix16_t)(((int64_t)a << 16) / b);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+// Boards without an FPU run float math in software, so calibration and
+// psychrometric formulas use Q16.16 fixed point there. Define
+// SENSORS_FLOAT_MATH to force the float path, or SENSORS_FIXED_POINT to
+// select fixed point on any board.
+#if defined(__AVR__) && !defined(SENSORS_FLOAT_MATH) && !defined(SENSORS_FIXED_POINT)
+#define SENSORS_FIXED_POINT
+#endif
+
+// Signed Q16.16: 16 integer bits, 16 fractional bits
+typedef int32_t fix16_t;
+
+static const fix16_t FIX16_ONE = 0x00010000;
+static const fix16_t FIX16_MAX = 0x7FFFFFFF;
+static const fix16_t FIX16_MIN = (fix16_t)0x80000000;
+
+constexpr fix16_t fix16FromInt(int value) {
+    return (fix16_t)value * FIX16_ONE;
+}
+
+constexpr fix16_t fix16FromFloat(float value) {
+    return (fix16_t)(value * 65536.0f + (value >= 0 ? 0.5f : -0.5f));
+}
+
+inline float fix16ToFloat(fix16_t value) {
+    return value / 65536.0f;
+}
+
+inline fix16_t fix16Mul(fix16_t a, fix16_t b) {
+#if defined(__AVR__)
+    // 16x16 partial products avoid the 64-bit multiply helper on AVR
+    int32_t high = (a >> 16) * (b >> 16);
+    int32_t middle = (a >> 16) * (int32_t)(b & 0xFFFF) + (b >> 16) * (int32_t)(a & 0xFFFF);
+    uint32_t low = (uint32_t)(a & 0xFFFF) * (uint32_t)(b & 0xFFFF);
+    return (high << 16) + middle + (fix16_t)(low >> 16);
+#else
+    return (fix16_t)(((int64_t)a * b) >> 16);
+#endif
+}
+
+// Saturates when b is 0 or the quotient does not fit
+fix16_t fix16Div(fix16_t a, fix16_t b);
+
+// Table-driven approximation, accurate to about 1e-3
+fix16_t fix16Log(fix16_t x);   // Natural log, x > 0
+
+#endif
\ No newline at end of file
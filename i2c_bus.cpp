@@ -0,0 +1,177 @@
+#include "i2c_bus.h"
+
+I2CBus i2cBus;
+
+I2CBus::I2CBus() : queueLength(0), deviceCount(0) {
+}
+
+bool I2CBus::readRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+    // Repeated start keeps the register pointer for the burst read
+    unsigned long started = micros();
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    bool ok = Wire.endTransmission(false) == 0 && Wire.requestFrom(address, length) == length;
+    for (uint8_t i = 0; ok && i < length; i++) {
+        buffer[i] = Wire.read();
+    }
+    account(address, started, length + 1, ok);
+    return ok;
+}
+
+bool I2CBus::read(uint8_t address, uint8_t* buffer, uint8_t length) {
+    unsigned long started = micros();
+    bool ok = Wire.requestFrom(address, length) == length;
+    for (uint8_t i = 0; ok && i < length; i++) {
+        buffer[i] = Wire.read();
+    }
+    account(address, started, length, ok);
+    return ok;
+}
+
+bool I2CBus::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    unsigned long started = micros();
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    Wire.write(value);
+    bool ok = Wire.endTransmission() == 0;
+    account(address, started, 2, ok);
+    return ok;
+}
+
+bool I2CBus::probe(uint8_t address) {
+    unsigned long started = micros();
+    Wire.beginTransmission(address);
+    bool ok = Wire.endTransmission() == 0;
+    account(address, started, 0, ok);
+    return ok;
+}
+
+bool I2CBus::submit(I2CTransaction& transaction) {
+    if (queueLength >= QUEUE_SIZE) return false;
+
+    // Insert behind every transaction of the same or higher priority. A
+    // partly sent transfer may be overtaken, it resumes at its offset.
+    uint8_t position = queueLength;
+    while (position > 0 && queue[position - 1]->priority > transaction.priority) {
+        queue[position] = queue[position - 1];
+        position--;
+    }
+    queue[position] = &transaction;
+    queueLength++;
+
+    transaction.offset = 0;
+    transaction.status = I2C_QUEUED;
+    return true;
+}
+
+void I2CBus::cancel(I2CTransaction& transaction) {
+    for (uint8_t i = 0; i < queueLength; i++) {
+        if (queue[i] == &transaction) {
+            for (uint8_t j = i + 1; j < queueLength; j++) {
+                queue[j - 1] = queue[j];
+            }
+            queueLength--;
+            break;
+        }
+    }
+    transaction.status = I2C_IDLE;
+}
+
+bool I2CBus::isBusy() const {
+    return queueLength > 0;
+}
+
+void I2CBus::service(unsigned long budgetMicros) {
+    unsigned long started = micros();
+    while (queueLength > 0 && micros() - started < budgetMicros) {
+        I2CTransaction& transaction = *queue[0];
+        if (!sendChunk(transaction)) {
+            transaction.status = I2C_FAILED;
+            removeFront();
+        } else if (transaction.offset >= transaction.length) {
+            transaction.status = I2C_DONE;
+            removeFront();
+        }
+    }
+}
+
+bool I2CBus::sendChunk(I2CTransaction& transaction) {
+    unsigned long started = micros();
+    uint8_t bytes;
+    Wire.beginTransmission(transaction.address);
+
+    if (transaction.status == I2C_QUEUED && transaction.headerLength > 0) {
+        Wire.write(transaction.header, transaction.headerLength);
+        bytes = transaction.headerLength;
+    } else {
+        uint16_t remaining = transaction.length - transaction.offset;
+        uint8_t size = remaining < CHUNK_SIZE ? remaining : CHUNK_SIZE;
+        Wire.write(transaction.prefix);
+        Wire.write(transaction.data + transaction.offset, size);
+        transaction.offset += size;
+        bytes = size + 1;
+    }
+    transaction.status = I2C_ACTIVE;
+
+    bool ok = Wire.endTransmission() == 0;
+    account(transaction.address, started, bytes, ok);
+    return ok;
+}
+
+void I2CBus::removeFront() {
+    for (uint8_t i = 1; i < queueLength; i++) {
+        queue[i - 1] = queue[i];
+    }
+    queueLength--;
+}
+
+void I2CBus::account(uint8_t address, unsigned long started, uint8_t bytes, bool ok) {
+    I2CDeviceStats* device = findDevice(address);
+    if (!device) {
+        if (deviceCount >= MAX_DEVICES) return;
+        device = &devices[deviceCount++];
+        *device = {address, 0, 0, 0, 0};
+    }
+
+    device->transfers++;
+    device->bytes += bytes;
+    device->busMicros += micros() - started;
+    if (!ok) device->errors++;
+}
+
+I2CDeviceStats* I2CBus::findDevice(uint8_t address) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) return &devices[i];
+    }
+    return nullptr;
+}
+
+const I2CDeviceStats* I2CBus::getDeviceStats(uint8_t address) const {
+    return const_cast<I2CBus*>(this)->findDevice(address);
+}
+
+unsigned long I2CBus::getBusTime(uint8_t address) const {
+    const I2CDeviceStats* device = getDeviceStats(address);
+    return device ? device->busMicros : 0;
+}
+
+void I2CBus::printStats(Print& out) const {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        const I2CDeviceStats& device = devices[i];
+        out.print(F("I2C 0x"));
+        out.print(device.address, HEX);
+        out.print(F(": "));
+        out.print(device.busMicros);
+        out.print(F(" us, "));
+        out.print(device.transfers);
+        out.print(F(" transfers, "));
+        out.print(device.bytes);
+        out.print(F(" bytes, "));
+        out.print(device.errors);
+        out.println(F(" errors"));
+    }
+}
+
+void I2CBus::resetStats() {
+    deviceCount = 0;
+}
\ No newline at end of file
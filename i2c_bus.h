@@ -0,0 +1,91 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Arbiter for the shared Wire bus (BH1750, BMP280, SSD1306). Short sensor
+// transfers run immediately; bulk writes such as display frames are queued
+// and sent in chunks by service(), so a sensor read never waits behind more
+// than one chunk.
+
+enum I2CPriority {
+    I2C_PRIORITY_HIGH,    // Sensor traffic
+    I2C_PRIORITY_NORMAL,
+    I2C_PRIORITY_LOW      // Display frames
+};
+
+enum I2CStatus {
+    I2C_IDLE,
+    I2C_QUEUED,
+    I2C_ACTIVE,           // Header sent, payload in progress
+    I2C_DONE,
+    I2C_FAILED
+};
+
+// Queued write, owned by the caller and left untouched by the bus once done
+struct I2CTransaction {
+    uint8_t address;
+    I2CPriority priority;
+    const uint8_t* header;      // Sent once as its own write, may be null
+    uint8_t headerLength;
+    const uint8_t* data;        // Sent in chunks, each led by prefix
+    uint16_t length;
+    uint8_t prefix;
+    uint16_t offset;            // Bytes of data already sent
+    I2CStatus status;
+};
+
+struct I2CDeviceStats {
+    uint8_t address;
+    unsigned long transfers;
+    unsigned long bytes;
+    unsigned long busMicros;
+    uint16_t errors;
+};
+
+class I2CBus {
+public:
+    // Wire's buffer holds 32 bytes, one is taken by the chunk prefix
+    static const uint8_t CHUNK_SIZE = 31;
+    static const uint8_t QUEUE_SIZE = 4;
+    static const uint8_t MAX_DEVICES = 6;
+    static const unsigned long DEFAULT_BUDGET_US = 2000;
+
+    I2CBus();
+
+    // Immediate transfers, accounted to the device
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length);
+    bool read(uint8_t address, uint8_t* buffer, uint8_t length);
+    bool writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+    bool probe(uint8_t address);
+
+    // Queued transfers, highest priority first, FIFO within a priority
+    bool submit(I2CTransaction& transaction);
+    void cancel(I2CTransaction& transaction);
+    bool isBusy() const;
+
+    // Send queued chunks until the time budget is used up
+    void service(unsigned long budgetMicros = DEFAULT_BUDGET_US);
+
+    // Per-device bus-time accounting
+    const I2CDeviceStats* getDeviceStats(uint8_t address) const;
+    unsigned long getBusTime(uint8_t address) const;
+    void printStats(Print& out) const;
+    void resetStats();
+
+private:
+    I2CTransaction* queue[QUEUE_SIZE];
+    uint8_t queueLength;
+    I2CDeviceStats devices[MAX_DEVICES];
+    uint8_t deviceCount;
+
+    bool sendChunk(I2CTransaction& transaction);
+    void removeFront();
+    void account(uint8_t address, unsigned long started, uint8_t bytes, bool ok);
+    I2CDeviceStats* findDevice(uint8_t address);
+};
+
+extern I2CBus i2cBus;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "led_renderer.h"
+
+LedRenderer::LedRenderer() : leds(NULL), count(0), dirty(false), lastFrame(0), shown(0) {
+    for (uint8_t i = 0; i < LED_LAYER_COUNT; i++) {
+        layers[i].effect = EFFECT_NONE;
+        layers[i].color = CRGB::Black;
+        layers[i].palette = NULL;
+        layers[i].opacity = 255;
+        layers[i].period = 1;
+        layers[i].start = 0;
+        layers[i].duration = 0;
+        layers[i].level = 255;
+        layers[i].fadeTime = 0;
+    }
+}
+
+void LedRenderer::begin(CRGB* leds, uint16_t count) {
+    this->leds = leds;
+    this->count = count;
+    dirty = true;
+}
+
+void LedRenderer::start(LedLayer layer, LedEffect effect, const CRGB& color, uint16_t period,
+                        unsigned long duration) {
+    Layer& target = layers[layer];
+    target.effect = effect;
+    target.color = color;
+    target.palette = NULL;
+    target.opacity = 255;
+    target.period = max(period, (uint16_t)1);
+    target.start = millis();
+    target.duration = duration;
+    dirty = true;
+}
+
+void LedRenderer::setSolid(LedLayer layer, const CRGB& color, uint8_t opacity) {
+    start(layer, EFFECT_SOLID, color, 1, 0);
+    layers[layer].opacity = opacity;
+}
+
+void LedRenderer::setPalette(LedLayer layer, const TProgmemRGBPalette16& palette, uint16_t period,
+                             unsigned long duration) {
+    start(layer, EFFECT_PALETTE, CRGB::Black, period, duration);
+    layers[layer].palette = &palette;
+}
+
+void LedRenderer::setPulse(LedLayer layer, const CRGB& color, uint16_t period, unsigned long duration) {
+    start(layer, EFFECT_PULSE, color, period, duration);
+}
+
+void LedRenderer::setBlink(LedLayer layer, const CRGB& color, uint16_t period, unsigned long duration) {
+    start(layer, EFFECT_BLINK, color, period, duration);
+}
+
+void LedRenderer::setColor(LedLayer layer, const CRGB& color) {
+    layers[layer].color = color;
+    dirty = true;
+}
+
+void LedRenderer::clear(LedLayer layer) {
+    layers[layer].effect = EFFECT_NONE;
+    dirty = true;
+}
+
+void LedRenderer::setLevel(LedLayer layer, uint8_t level, uint16_t fadeTime) {
+    Layer& target = layers[layer];
+    if (fadeTime == 0) {
+        target.level = level;
+        target.fadeTime = 0;
+    } else {
+        target.fadeFrom = target.level;
+        target.fadeTo = level;
+        target.fadeTime = fadeTime;
+        target.fadeStart = millis();
+    }
+    dirty = true;
+}
+
+bool LedRenderer::update(Layer& layer, unsigned long now) {
+    // Returns true when the layer's contribution depends on the time
+    bool varying = false;
+    if (layer.fadeTime > 0) {
+        unsigned long elapsed = now - layer.fadeStart;
+        if (elapsed >= layer.fadeTime) {
+            layer.level = layer.fadeTo;
+            layer.fadeTime = 0;
+        } else {
+            layer.level = lerp8by8(layer.fadeFrom, layer.fadeTo,
+                                   ease8InOutCubic(elapsed * 255 / layer.fadeTime));
+        }
+        varying = true;
+    }
+    
+    if (layer.effect == EFFECT_NONE) return false;
+    if (layer.duration > 0 && now - layer.start >= layer.duration) {
+        // Expired, one more frame without it
+        layer.effect = EFFECT_NONE;
+        return true;
+    }
+    return varying || layer.effect != EFFECT_SOLID;
+}
+
+uint8_t LedRenderer::coverage(const Layer& layer, unsigned long now) const {
+    // Position within the current period as an 8-bit phase
+    uint8_t phase = ((now - layer.start) % layer.period) * 256 / layer.period;
+    switch (layer.effect) {
+        case EFFECT_PULSE:
+            return quadwave8(phase);
+        case EFFECT_BLINK:
+            return phase < 128 ? 255 : 0;
+        case EFFECT_NONE:
+            return 0;
+        default:
+            return 255;
+    }
+}
+
+bool LedRenderer::render(unsigned long now) {
+    if (!leds || now - lastFrame < FRAME_INTERVAL) return false;
+    
+    bool animated = false;
+    for (uint8_t l = 0; l < LED_LAYER_COUNT; l++) {
+        if (update(layers[l], now)) animated = true;
+    }
+    if (!animated && !dirty) return false;
+    lastFrame = now;
+    dirty = false;
+    
+    // Per-layer terms that do not depend on the pixel
+    uint8_t alpha[LED_LAYER_COUNT];
+    CRGB color[LED_LAYER_COUNT];
+    uint8_t offset[LED_LAYER_COUNT];
+    for (uint8_t l = 0; l < LED_LAYER_COUNT; l++) {
+        const Layer& layer = layers[l];
+        alpha[l] = scale8(coverage(layer, now), layer.opacity);
+        color[l] = layer.color;
+        color[l].nscale8_video(layer.level);
+        offset[l] = ((now - layer.start) % layer.period) * 256 / layer.period;
+    }
+    
+    bool changed = false;
+    for (uint16_t i = 0; i < count; i++) {
+        CRGB pixel = CRGB::Black;
+        for (uint8_t l = 0; l < LED_LAYER_COUNT; l++) {
+            if (alpha[l] == 0) continue;
+            if (layers[l].effect == EFFECT_PALETTE) {
+                uint8_t index = (uint8_t)(i * 256 / count) + offset[l];
+                nblend(pixel, ColorFromPalette(*layers[l].palette, index, layers[l].level), alpha[l]);
+            } else {
+                nblend(pixel, color[l], alpha[l]);
+            }
+        }
+        if (pixel != leds[i]) {
+            leds[i] = pixel;
+            changed = true;
+        }
+    }
+    
+    if (changed) {
+        FastLED.show();
+        shown++;
+    }
+    return changed;
+}
+
+uint8_t LedRenderer::level(LedLayer layer) const {
+    return layers[layer].level;
+}
+
+LedEffect LedRenderer::effect(LedLayer layer) const {
+    return (LedEffect)layers[layer].effect;
+}
+
+unsigned long LedRenderer::framesShown() const {
+    return shown;
+}
\ No newline at end of file
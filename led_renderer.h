@@ -0,0 +1,81 @@
+#ifndef LED_RENDERER_H
+#define LED_RENDERER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Layers are composited bottom to top, e.g. an ALERT blink over AMBIENT
+enum LedLayer {
+    LAYER_BASE,       // Room lighting mode
+    LAYER_EFFECT,     // Light shows and pulses
+    LAYER_ALERT,      // Warnings, drawn over everything
+    LED_LAYER_COUNT
+};
+
+enum LedEffect {
+    EFFECT_NONE,
+    EFFECT_SOLID,
+    EFFECT_PALETTE,   // Palette scrolling along the strip
+    EFFECT_PULSE,     // Color fading in and out, one pulse per period
+    EFFECT_BLINK      // Color on for half the period, lower layers otherwise
+};
+
+// Frame-budgeted effect engine for an addressable strip. Effects are
+// rendered with 8-bit math straight into the LED buffer and show() is
+// only called when a pixel actually changed, so static scenes cost no
+// strip writes (each one holds off interrupts for the whole strip).
+class LedRenderer {
+public:
+    static const uint8_t FRAME_INTERVAL = 20;   // ms, caps rendering at 50 fps
+
+    LedRenderer();
+    void begin(CRGB* leds, uint16_t count);
+
+    // Duration 0 keeps an effect until it is replaced or cleared
+    void setSolid(LedLayer layer, const CRGB& color, uint8_t opacity = 255);
+    void setPalette(LedLayer layer, const TProgmemRGBPalette16& palette, uint16_t period,
+                    unsigned long duration = 0);
+    void setPulse(LedLayer layer, const CRGB& color, uint16_t period, unsigned long duration = 0);
+    void setBlink(LedLayer layer, const CRGB& color, uint16_t period, unsigned long duration = 0);
+    void setColor(LedLayer layer, const CRGB& color);
+    void clear(LedLayer layer);
+    // Brightness of a layer, eased towards the new level over fadeTime ms
+    void setLevel(LedLayer layer, uint8_t level, uint16_t fadeTime = 0);
+
+    // Returns true when a new frame was sent to the strip
+    bool render(unsigned long now);
+
+    uint8_t level(LedLayer layer) const;
+    LedEffect effect(LedLayer layer) const;
+    unsigned long framesShown() const;
+
+private:
+    struct Layer {
+        uint8_t effect;
+        CRGB color;
+        const TProgmemRGBPalette16* palette;
+        uint8_t opacity;
+        uint16_t period;
+        unsigned long start;
+        unsigned long duration;
+        uint8_t level;
+        uint8_t fadeFrom;
+        uint8_t fadeTo;
+        uint16_t fadeTime;
+        unsigned long fadeStart;
+    };
+
+    CRGB* leds;
+    uint16_t count;
+    Layer layers[LED_LAYER_COUNT];
+    bool dirty;                   // Layer settings changed since the last frame
+    unsigned long lastFrame;
+    unsigned long shown;
+
+    void start(LedLayer layer, LedEffect effect, const CRGB& color, uint16_t period,
+               unsigned long duration);
+    bool update(Layer& layer, unsigned long now);
+    uint8_t coverage(const Layer& layer, unsigned long now) const;
+};
+
+#endif
\ No newline at end of file
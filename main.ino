@@ -2,6 +2,9 @@
 #include "display.h"
 #include "actuators.h"
 #include "automation.h"
+#include "i2c_bus.h"
+#include "timer_wheel.h"
+#include "task_scheduler.h"
 #include "network.h"
 #include "storage.h"
 
@@ -13,6 +16,7 @@
 #define SERVO_PIN 6
 #define WINDOW_SERVO_PIN 7
 #define LDRPIN A0
+#define AIR_SENSOR_PIN A1
 #define BUZZERPIN 8
 #define RAIN_SENSOR_PIN A2
 #define SOIL_MOISTURE_PIN A3
@@ -49,12 +53,17 @@ const unsigned long WEATHER_UPDATE_INTERVAL = 1800000; // 30 minutes
 bool autoMode = true;
 bool energySaveMode = false;
 bool gardenMode = false;
-unsigned long lastSensorRead = 0;
-unsigned long lastDisplayUpdate = 0;
-unsigned long lastDataLog = 0;
-unsigned long lastWeatherUpdate = 0;
-float temperatureHistory[24] = {0};
-int historyIndex = 0;
+
+// Latest snapshot shared by the loop tasks
+SensorData sensorData;
+bool sensorDataValid = false;
+
+// Loop tasks, see setupTasks()
+TaskId sensorTaskId;
+TaskId emergencyTaskId;
+TaskId automationTaskId;
+TaskId networkTaskId;
+uint8_t automationStage = 0;
 
 // Error handling
 bool systemError = false;
@@ -64,7 +73,7 @@ void setup() {
     Serial.begin(9600);
     
     // Initialize components with error checking
-    sensors.begin();
+    sensors.begin(AIR_SENSOR_PIN);
     if (!sensors.performSelfTest()) {
         systemError = true;
         errorMessage = "Sensor initialization failed";
@@ -98,128 +107,185 @@ void setup() {
         delay(2000);
     }
     
-    // Initialize weather data
+    // Initialize weather data, the weather task refreshes it
     updateWeatherForecast();
+    setupTasks();
+    
+    // Opened doors lock themselves again
+    actuators.autoCloseDoor(AUTO_CLOSE_DELAY);
+    
+    // Daily and weekly schedules follow the wall clock; there is no time
+    // source here, call timers.setClock() once one (NTP, RTC) is fitted
 }
 
-void loop() {
-    unsigned long currentMillis = millis();
+void setupTasks() {
+    // Recurring loop work, weather included, runs here; the timer wheel
+    // only keeps wall-clock schedules and delayed actuator actions.
+    // Budgets in us; emergency, automation and network checks follow each sensor read
+    sensorTaskId = scheduler.add(F("sensors"), sensorTask, SENSOR_READ_INTERVAL, TASK_HIGH, 5000);
+    emergencyTaskId = scheduler.add(F("emergency"), emergencyTask, 0, TASK_CRITICAL, 2000);
+    automationTaskId = scheduler.add(F("automation"), automationTask, 0, TASK_NORMAL, 5000);
+    scheduler.add(F("display"), displayTask, DISPLAY_UPDATE_INTERVAL, TASK_NORMAL, 10000);
+    networkTaskId = scheduler.add(F("network"), networkTask, 0, TASK_LOW, 20000);
+    scheduler.add(F("logging"), loggingTask, DATA_LOGGING_INTERVAL, TASK_LOW, 20000);
+    TaskId weatherTaskId = scheduler.add(F("weather"), weatherTask, WEATHER_UPDATE_INTERVAL, TASK_LOW, 50000);
+    scheduler.schedule(weatherTaskId, WEATHER_UPDATE_INTERVAL);
+}
+
+void sensorTask(void* context) {
+    // Nothing to read until the first conversions have completed
+    if (!sensors.hasReadings()) return;
     
-    // Basic error recovery
-    if (systemError) {
-        handleSystemError();
+    // Get comprehensive sensor readings with error checking
+    if (!getSensorReadings(&sensorData)) {
+        systemError = true;
+        errorMessage = "Failed to read sensors";
         return;
     }
+    sensorDataValid = true;
     
-    // Read sensors at regular intervals with overflow protection
-    if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL || currentMillis < lastSensorRead) {
-        lastSensorRead = currentMillis;
-        
-        // Get comprehensive sensor readings with error checking
-        SensorData sensorData;
-        if (!getSensorReadings(&sensorData)) {
-            systemError = true;
-            errorMessage = "Failed to read sensors";
-            return;
-        }
-        
-        // Update temperature history with bounds checking
-        if (historyIndex < 24) {
-            temperatureHistory[historyIndex] = sensorData.temperature;
-            historyIndex = (historyIndex + 1) % 24;
-        }
-        
-        // Automatic control logic with error handling
-        if (autoMode) {
-            try {
-                automation.handleClimateControl(sensorData, weatherForecast);
-                
-                if (gardenMode) {
+    // A new snapshot starts a new cycle, actuator sources from the last one
+    // no longer hold
+    actuators.beginIntentCycle();
+    scheduler.schedule(emergencyTaskId);
+    if (autoMode) {
+        automationStage = 0;
+        scheduler.schedule(automationTaskId);
+    }
+    scheduler.schedule(networkTaskId);
+}
+
+void emergencyTask(void* context) {
+    actuators.setIntentSource(SOURCE_SECURITY);
+    checkEmergencyConditions(sensorData);
+    actuators.setIntentSource(SOURCE_USER);
+}
+
+void automationTask(void* context) {
+    // One handler per slice, each only runs when a field it uses moved
+    // past its deadband. Actuator requests are tagged with their source
+    // and resolved by priority until the next sensor cycle, even though
+    // the stages are committed over several loop passes.
+    try {
+        switch (automationStage) {
+            case HANDLER_CLIMATE:
+                actuators.setIntentSource(SOURCE_CLIMATE);
+                if (automation.isHandlerDue(HANDLER_CLIMATE, sensorData)) {
+                    automation.handleClimateControl(sensorData, weatherForecast);
+                }
+                break;
+            case HANDLER_GARDEN:
+                actuators.setIntentSource(SOURCE_CLIMATE);
+                if (gardenMode && automation.isHandlerDue(HANDLER_GARDEN, sensorData)) {
                     automation.handleGardenCare(sensorData, weatherForecast);
                 }
-                
-                if (energySaveMode) {
+                break;
+            case HANDLER_ENERGY:
+                actuators.setIntentSource(SOURCE_COMFORT);
+                if (energySaveMode && automation.isHandlerDue(HANDLER_ENERGY, sensorData)) {
                     automation.handleEnergyManagement(sensorData);
                 }
-                
-                automation.handleSecurity(sensorData);
-                automation.optimizeComfort(sensorData);
-            } catch (...) {
-                systemError = true;
-                errorMessage = "Automation error";
-                return;
-            }
-        }
-        
-        // Emergency conditions check
-        checkEmergencyConditions(sensorData);
-        
-        // Log data periodically with overflow protection
-        if (currentMillis - lastDataLog >= DATA_LOGGING_INTERVAL || currentMillis < lastDataLog) {
-            lastDataLog = currentMillis;
-            if (!storage.logSensorData(sensorData)) {
-                Serial.println("Failed to log sensor data");
-            }
-        }
-        
-        // Update weather forecast periodically with overflow protection
-        if (currentMillis - lastWeatherUpdate >= WEATHER_UPDATE_INTERVAL || currentMillis < lastWeatherUpdate) {
-            lastWeatherUpdate = currentMillis;
-            updateWeatherForecast();
-        }
-        
-        // Update display with current readings
-        if (currentMillis - lastDisplayUpdate >= DISPLAY_UPDATE_INTERVAL || currentMillis < lastDisplayUpdate) {
-            lastDisplayUpdate = currentMillis;
-            updateDisplayInfo(sensorData);
-        }
-        
-        // Network updates with error handling
-        try {
-            network.sendStatusUpdate(sensorData);
-            handleNetworkCommands();
-        } catch (...) {
-            Serial.println("Network communication error");
+                break;
+            case HANDLER_SECURITY:
+                actuators.setIntentSource(SOURCE_SECURITY);
+                if (automation.isHandlerDue(HANDLER_SECURITY, sensorData)) {
+                    automation.handleSecurity(sensorData);
+                }
+                break;
+            case HANDLER_COMFORT:
+                actuators.setIntentSource(SOURCE_COMFORT);
+                if (automation.isHandlerDue(HANDLER_COMFORT, sensorData)) {
+                    automation.optimizeComfort(sensorData);
+                }
+                break;
+            default:
+                actuators.setIntentSource(SOURCE_USER);
+                automation.processAutomationRules(sensorData);
+                break;
         }
+    } catch (...) {
+        actuators.setIntentSource(SOURCE_USER);
+        systemError = true;
+        errorMessage = "Automation error";
+        return;
     }
+    actuators.setIntentSource(SOURCE_USER);
     
-    // Check for door auto-close with overflow protection
-    if (actuators.getDoorState() != LOCKED && 
-        (currentMillis - lastSensorRead >= AUTO_CLOSE_DELAY || currentMillis < lastSensorRead)) {
-        actuators.setDoorState(LOCKED);
-        Serial.println("Auto-closing door");
-    }
+    // The rules run after the last handler
+    if (++automationStage <= HANDLER_COUNT) scheduler.schedule(automationTaskId);
 }
 
-bool getSensorReadings(SensorData* data) {
+void displayTask(void* context) {
+    if (sensorDataValid) updateDisplayInfo(sensorData);
+}
+
+void networkTask(void* context) {
+    // Network updates with error handling
     try {
-        data->temperature = sensors.getAverageTemperature();
-        data->humidity = sensors.getAverageHumidity();
-        data->pressure = sensors.getAveragePressure();
-        data->motion = sensors.getMotion();
-        data->lightLevel = sensors.getPreciseLightLevel();
-        data->isRaining = sensors.isRaining();
-        data->airQuality = sensors.getAirQuality();
-        data->soilMoisture = sensors.getSoilMoisture();
-        data->uvIndex = sensors.getUVIndex();
-        data->waterLevel = sensors.getWaterLevel();
-        return true;
+        network.sendStatusUpdate(sensorData);
+        handleNetworkCommands();
     } catch (...) {
-        return false;
+        Serial.println("Network communication error");
+    }
+}
+
+void loggingTask(void* context) {
+    if (sensorDataValid && !storage.logSensorData(sensorData)) {
+        Serial.println("Failed to log sensor data");
+    }
+}
+
+void weatherTask(void* context) {
+    updateWeatherForecast();
+}
+
+void loop() {
+    // Drain queued I2C transfers (display frames) in short slices
+    i2cBus.service();
+    
+    // Scheduled and delayed tasks
+    timers.service();
+    
+    // Advance sensor acquisition, slow devices are retried on later passes.
+    // Keeps running in the error state so failed devices can come back.
+    sensors.tick();
+    
+    // Basic error recovery
+    if (systemError) {
+        handleSystemError();
+        return;
+    }
+    
+    // Door and window servos move in the background
+    actuators.tick();
+    uint8_t motionEvents = actuators.pollMotionEvents();
+    if (motionEvents & MOTION_DOOR_DONE) {
+        Serial.println(actuators.getDoorState() == LOCKED ? "Door locked" : "Door in position");
     }
+    if (motionEvents & MOTION_WINDOW_DONE) {
+        Serial.println("Window in position");
+    }
+    
+    // Sensor reads, automation, display, logging, weather and network
+    // updates, highest priority first within the loop slice
+    scheduler.service();
+}
+
+bool getSensorReadings(SensorData* data) {
+    // One snapshot per cycle, each device was read once by sensors.tick()
+    return sensors.readSnapshot(*data);
 }
 
 void handleSystemError() {
     static unsigned long lastErrorDisplay = 0;
     unsigned long currentMillis = millis();
     
-    // Display error message every 5 seconds
-    if (currentMillis - lastErrorDisplay >= 5000 || currentMillis < lastErrorDisplay) {
-        display.showAlert("System Error: " + errorMessage);
-        lastErrorDisplay = currentMillis;
-    }
+    // Display error message and try to recover every 5 seconds, each
+    // failed self-test logs an error record
+    if (currentMillis - lastErrorDisplay < 5000 && currentMillis >= lastErrorDisplay) return;
+    display.showAlert("System Error: " + errorMessage);
+    lastErrorDisplay = currentMillis;
     
-    // Try to recover
     if (sensors.performSelfTest()) {
         systemError = false;
         errorMessage = "";
@@ -0,0 +1,139 @@
+#include "psychrometrics.h"
+
+// Magnus coefficients
+static const float MAGNUS_A = 17.27;
+static const float MAGNUS_B = 237.7;
+
+float Psychrometrics::dewPoint(float temperature, float humidity) {
+#ifdef SENSORS_FIXED_POINT
+    return fix16ToFloat(dewPointFixed(fix16FromFloat(temperature), fix16FromFloat(humidity)));
+#else
+    return dewPointFloat(temperature, humidity);
+#endif
+}
+
+float Psychrometrics::heatIndex(float temperature, float humidity) {
+#ifdef SENSORS_FIXED_POINT
+    return fix16ToFloat(heatIndexFixed(fix16FromFloat(temperature), fix16FromFloat(humidity)));
+#else
+    return heatIndexFloat(temperature, humidity);
+#endif
+}
+
+float Psychrometrics::dewPointFloat(float temperature, float humidity) {
+    float gamma = (MAGNUS_A * temperature) / (MAGNUS_B + temperature) + log(humidity / 100.0);
+    return (MAGNUS_B * gamma) / (MAGNUS_A - gamma);
+}
+
+float Psychrometrics::heatIndexFloat(float temperature, float humidity) {
+    // Rothfusz regression, evaluated in Fahrenheit
+    float t = temperature * 1.8 + 32;
+    float simple = 0.5 * (t + 61.0 + (t - 68.0) * 1.2 + humidity * 0.094);
+    if ((simple + t) / 2 < 80) {
+        return (simple - 32) / 1.8;
+    }
+
+    float hi = -42.379 + 2.04901523 * t + 10.14333127 * humidity
+             - 0.22475541 * t * humidity - 0.00683783 * t * t
+             - 0.05481717 * humidity * humidity + 0.00122874 * t * t * humidity
+             + 0.00085282 * t * humidity * humidity - 0.00000199 * t * t * humidity * humidity;
+    return (hi - 32) / 1.8;
+}
+
+fix16_t Psychrometrics::dewPointFixed(fix16_t temperature, fix16_t humidity) {
+    const fix16_t a = fix16FromFloat(MAGNUS_A);
+    const fix16_t b = fix16FromFloat(MAGNUS_B);
+
+    if (humidity <= 0) return FIX16_MIN;
+    fix16_t gamma = fix16Div(fix16Mul(a, temperature), b + temperature) + fix16Log(humidity / 100);
+    return fix16Div(fix16Mul(b, gamma), a - gamma);
+}
+
+fix16_t Psychrometrics::heatIndexFixed(fix16_t temperature, fix16_t humidity) {
+    const fix16_t F32 = fix16FromInt(32);
+    const fix16_t C_TO_F = fix16FromFloat(1.8);
+    const fix16_t F_TO_C = fix16FromFloat(1 / 1.8);
+
+    fix16_t t = fix16Mul(temperature, C_TO_F) + F32;
+    fix16_t simple = (t + fix16FromInt(61) + fix16Mul(t - fix16FromInt(68), fix16FromFloat(1.2))
+                      + fix16Mul(humidity, fix16FromFloat(0.094))) / 2;
+    if ((simple + t) / 2 < fix16FromInt(80)) {
+        return fix16Mul(simple - F32, F_TO_C);
+    }
+
+    // Same regression on t/100 and RH/100 so every coefficient and partial
+    // product stays well inside the Q16.16 range
+    fix16_t tt = t / 100;
+    fix16_t rr = humidity / 100;
+    fix16_t tt2 = fix16Mul(tt, tt);
+
+    fix16_t base = fix16FromFloat(-42.379) + fix16Mul(fix16FromFloat(204.901523), tt)
+                 + fix16Mul(fix16FromFloat(-68.3783), tt2);
+    fix16_t linear = fix16FromFloat(1014.333127) + fix16Mul(fix16FromFloat(-2247.5541), tt)
+                   + fix16Mul(fix16FromFloat(1228.74), tt2);
+    fix16_t quadratic = fix16FromFloat(-548.1717) + fix16Mul(fix16FromFloat(852.82), tt)
+                      + fix16Mul(fix16FromFloat(-199.0), tt2);
+
+    fix16_t hi = base + fix16Mul(rr, linear + fix16Mul(rr, quadratic));
+    return fix16Mul(hi - F32, F_TO_C);
+}
+
+void Psychrometrics::benchmark(Print& out, int iterations) {
+    // Grid over -10..40 degC and 10..100 %RH
+    const int T_STEPS = 11;
+    const int RH_STEPS = 10;
+    float temps[T_STEPS];
+    float rhs[RH_STEPS];
+    fix16_t tempsFixed[T_STEPS];
+    fix16_t rhsFixed[RH_STEPS];
+    for (int i = 0; i < T_STEPS; i++) {
+        temps[i] = -10 + i * 5;
+        tempsFixed[i] = fix16FromFloat(temps[i]);
+    }
+    for (int i = 0; i < RH_STEPS; i++) {
+        rhs[i] = 10 + i * 10;
+        rhsFixed[i] = fix16FromFloat(rhs[i]);
+    }
+
+    // Accuracy against the float reference
+    float dewError = 0;
+    float heatError = 0;
+    for (int i = 0; i < T_STEPS; i++) {
+        for (int j = 0; j < RH_STEPS; j++) {
+            float dew = fix16ToFloat(dewPointFixed(tempsFixed[i], rhsFixed[j]));
+            float heat = fix16ToFloat(heatIndexFixed(tempsFixed[i], rhsFixed[j]));
+            dewError = max(dewError, (float)fabs(dew - dewPointFloat(temps[i], rhs[j])));
+            heatError = max(heatError, (float)fabs(heat - heatIndexFloat(temps[i], rhs[j])));
+        }
+    }
+
+    // Speed of each path over the same grid
+    volatile float floatSink = 0;
+    volatile fix16_t fixedSink = 0;
+    unsigned long start = micros();
+    for (int n = 0; n < iterations; n++) {
+        floatSink = dewPointFloat(temps[n % T_STEPS], rhs[n % RH_STEPS]);
+        floatSink = heatIndexFloat(temps[n % T_STEPS], rhs[n % RH_STEPS]);
+    }
+    unsigned long floatTime = micros() - start;
+
+    start = micros();
+    for (int n = 0; n < iterations; n++) {
+        fixedSink = dewPointFixed(tempsFixed[n % T_STEPS], rhsFixed[n % RH_STEPS]);
+        fixedSink = heatIndexFixed(tempsFixed[n % T_STEPS], rhsFixed[n % RH_STEPS]);
+    }
+    unsigned long fixedTime = micros() - start;
+    (void)floatSink;
+    (void)fixedSink;
+
+    out.print(F("Psychrometrics benchmark, iterations: "));
+    out.println(iterations);
+    out.print(F("Float path us/cycle: "));
+    out.println((float)floatTime / iterations, 2);
+    out.print(F("Fixed path us/cycle: "));
+    out.println((float)fixedTime / iterations, 2);
+    out.print(F("Max dew point error C: "));
+    out.println(dewError, 4);
+    out.print(F("Max heat index error C: "));
+    out.println(heatError, 4);
+}
\ No newline at end of file
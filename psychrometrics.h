@@ -0,0 +1,25 @@
+#ifndef PSYCHROMETRICS_H
+#define PSYCHROMETRICS_H
+
+#include <Arduino.h>
+#include "fixed_point.h"
+
+// Dew point and heat index shared by Sensors and Automation. The default
+// entry points pick the fixed-point or float implementation at compile
+// time (see SENSORS_FIXED_POINT in fixed_point.h).
+class Psychrometrics {
+public:
+    static float dewPoint(float temperature, float humidity);
+    static float heatIndex(float temperature, float humidity);
+
+    // Explicit implementations, temperature in degC and humidity in %RH
+    static float dewPointFloat(float temperature, float humidity);
+    static float heatIndexFloat(float temperature, float humidity);
+    static fix16_t dewPointFixed(fix16_t temperature, fix16_t humidity);
+    static fix16_t heatIndexFixed(fix16_t temperature, fix16_t humidity);
+
+    // Accuracy-vs-speed comparison of both paths over the indoor range
+    static void benchmark(Print& out, int iterations = 100);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,380 @@
+#include "rule_engine.h"
+#include "actuators.h"
+
+enum RuleOpcode {
+    OP_FIELD,       // Followed by the field index
+    OP_CONST,       // Followed by a float
+    OP_TEST,        // Value above zero
+    OP_NOT,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_EQ,
+    OP_NE,
+    OP_AND,
+    OP_OR
+};
+
+// Names in SensorField and RuleActionTarget order, kept in flash
+static const char FIELD_NAMES[] PROGMEM =
+    "temperature|humidity|pressure|altitude|dewpoint|heatindex|motion|light|rain|"
+    "airquality|co2|gas|aqi|soil|uv|water|noise|predicted";
+static const char TARGET_NAMES[] PROGMEM = "fan|window|door|light|mode|alarm|buzzer";
+static const char VALUE_NAMES[] PROGMEM =
+    "off|low|medium|high|locked|unlocked|partial|normal|ambient|night|party|alert|on";
+static const int16_t VALUES[] PROGMEM = {
+    0, 85, 170, 255,                    // FanSpeed
+    LOCKED, UNLOCKED, PARTIALLY_OPEN,
+    NORMAL, AMBIENT, NIGHT, PARTY, ALERT,
+    1
+};
+
+// Sample conditions for the benchmark
+static const char BENCHMARK_RULE_0[] PROGMEM = "temperature > 28 && humidity >= 60";
+static const char BENCHMARK_RULE_1[] PROGMEM = "co2 > 1000 || gas > 200";
+static const char BENCHMARK_RULE_2[] PROGMEM = "!rain && (light < 300 || motion)";
+static const char BENCHMARK_RULE_3[] PROGMEM = "soil < 30 && uv < 8 && !rain";
+static const char BENCHMARK_RULE_4[] PROGMEM = "dewpoint > 18 && temperature > 24";
+static const char BENCHMARK_RULE_5[] PROGMEM = "water < 20";
+static const char BENCHMARK_RULE_6[] PROGMEM = "motion && light < 50 && !(aqi > 100)";
+static const char BENCHMARK_RULE_7[] PROGMEM = "aqi > 150 || (airquality < 40 && co2 > 800)";
+static const char* const BENCHMARK_RULES[] PROGMEM = {
+    BENCHMARK_RULE_0, BENCHMARK_RULE_1, BENCHMARK_RULE_2, BENCHMARK_RULE_3,
+    BENCHMARK_RULE_4, BENCHMARK_RULE_5, BENCHMARK_RULE_6, BENCHMARK_RULE_7
+};
+static const uint8_t BENCHMARK_TEMPLATES = sizeof(BENCHMARK_RULES) / sizeof(BENCHMARK_RULES[0]);
+
+static int lookupName(PGM_P table, const char* token, uint8_t length) {
+    // Index of a case-insensitive match in a '|' separated flash list
+    int index = 0;
+    PGM_P entry = table;
+    while (true) {
+        uint8_t i = 0;
+        char c;
+        while ((c = pgm_read_byte(entry + i)) != '|' && c != '\0' && i < length &&
+               tolower(token[i]) == c) {
+            i++;
+        }
+        if (i == length && (c == '|' || c == '\0')) return index;
+        
+        while ((c = pgm_read_byte(entry)) != '|' && c != '\0') entry++;
+        if (c == '\0') return -1;
+        entry++;
+        index++;
+    }
+}
+
+// Recursive descent over the condition text, emitting postfix code
+struct RuleParser {
+    const char* p;
+    RuleProgram* program;
+    uint8_t depth;
+    uint8_t nesting;
+    bool ok;
+};
+
+static void skipSpace(RuleParser& parser) {
+    while (isspace(*parser.p)) parser.p++;
+}
+
+static bool accept(RuleParser& parser, const char* token) {
+    skipSpace(parser);
+    size_t length = strlen(token);
+    if (strncmp(parser.p, token, length) != 0) return false;
+    parser.p += length;
+    return true;
+}
+
+static void emit(RuleParser& parser, uint8_t op, int8_t stackChange) {
+    RuleProgram& program = *parser.program;
+    if (program.length >= RuleProgram::MAX_CODE) {
+        parser.ok = false;
+        return;
+    }
+    program.code[program.length++] = op;
+    parser.depth += stackChange;
+    if (parser.depth > RuleEngine::MAX_STACK) parser.ok = false;
+}
+
+static void emitConst(RuleParser& parser, float value) {
+    RuleProgram& program = *parser.program;
+    if (program.length + 1 + sizeof(float) > RuleProgram::MAX_CODE) {
+        parser.ok = false;
+        return;
+    }
+    emit(parser, OP_CONST, 1);
+    memcpy(&program.code[program.length], &value, sizeof(float));
+    program.length += sizeof(float);
+}
+
+static void parseOr(RuleParser& parser);
+
+static bool parseOperand(RuleParser& parser) {
+    // A field or a number, returns true for fields
+    skipSpace(parser);
+    if (isalpha(*parser.p)) {
+        const char* start = parser.p;
+        while (isalnum(*parser.p)) parser.p++;
+        int field = lookupName(FIELD_NAMES, start, parser.p - start);
+        if (field < 0) {
+            parser.ok = false;
+            return false;
+        }
+        emit(parser, OP_FIELD, 1);
+        if (parser.program->length < RuleProgram::MAX_CODE) {
+            parser.program->code[parser.program->length++] = field;
+        } else {
+            parser.ok = false;
+        }
+        parser.program->fieldMask |= FIELD_BIT(field);
+        return true;
+    }
+    
+    char* end;
+    float value = strtod(parser.p, &end);
+    if (end == parser.p) {
+        parser.ok = false;
+        return false;
+    }
+    parser.p = end;
+    emitConst(parser, value);
+    return false;
+}
+
+static void parseUnary(RuleParser& parser) {
+    if (!parser.ok) return;
+    // Bounds the recursion on small stacks
+    if (++parser.nesting > RuleEngine::MAX_STACK) {
+        parser.ok = false;
+        return;
+    }
+    if (accept(parser, "!")) {
+        parseUnary(parser);
+        emit(parser, OP_NOT, 0);
+        parser.program->branches = true;
+        parser.nesting--;
+        return;
+    }
+    if (accept(parser, "(")) {
+        parseOr(parser);
+        if (!accept(parser, ")")) parser.ok = false;
+        parser.nesting--;
+        return;
+    }
+    parser.nesting--;
+    
+    bool field = parseOperand(parser);
+    uint8_t op;
+    // Two-character operators first
+    if (accept(parser, "<=")) op = OP_LE;
+    else if (accept(parser, ">=")) op = OP_GE;
+    else if (accept(parser, "==")) op = OP_EQ;
+    else if (accept(parser, "!=")) op = OP_NE;
+    else if (accept(parser, "<")) op = OP_LT;
+    else if (accept(parser, ">")) op = OP_GT;
+    else {
+        // A lone field reads as a flag, a lone number is an error
+        if (field) {
+            emit(parser, OP_TEST, 0);
+        } else {
+            parser.ok = false;
+        }
+        return;
+    }
+    parseOperand(parser);
+    emit(parser, op, -1);
+}
+
+static void parseAnd(RuleParser& parser) {
+    parseUnary(parser);
+    while (parser.ok && accept(parser, "&&")) {
+        parseUnary(parser);
+        emit(parser, OP_AND, -1);
+    }
+}
+
+static void parseOr(RuleParser& parser) {
+    parseAnd(parser);
+    while (parser.ok && accept(parser, "||")) {
+        parseAnd(parser);
+        emit(parser, OP_OR, -1);
+        parser.program->branches = true;
+    }
+}
+
+bool RuleEngine::compileCondition(const char* text, RuleProgram& program) {
+    program.length = 0;
+    program.fieldMask = 0;
+    program.branches = false;
+    
+    RuleParser parser = {text, &program, 0, 0, true};
+    parseOr(parser);
+    skipSpace(parser);
+    if (!parser.ok || *parser.p != '\0' || parser.depth != 1) {
+        program.length = 0;
+        program.fieldMask = 0;
+        program.branches = false;
+        return false;
+    }
+    return true;
+}
+
+bool RuleEngine::compileActions(const char* text, RuleProgram& program) {
+    program.actionCount = 0;
+    const char* p = text;
+    
+    while (*p) {
+        while (isspace(*p) || *p == ';') p++;
+        if (!*p) break;
+        if (program.actionCount >= RuleProgram::MAX_ACTIONS) return false;
+        
+        const char* start = p;
+        while (isalpha(*p)) p++;
+        int target = lookupName(TARGET_NAMES, start, p - start);
+        if (target < 0) return false;
+        
+        // The value is optional ("alarm") and may be a number or a name
+        int16_t value = 1;
+        while (isspace(*p)) p++;
+        if (*p == '=') {
+            p++;
+            while (isspace(*p)) p++;
+            if (isalpha(*p)) {
+                start = p;
+                while (isalpha(*p)) p++;
+                int index = lookupName(VALUE_NAMES, start, p - start);
+                if (index < 0) return false;
+                value = pgm_read_word(&VALUES[index]);
+            } else {
+                char* end;
+                value = strtol(p, &end, 10);
+                if (end == p) return false;
+                p = end;
+            }
+        }
+        
+        RuleAction& action = program.actions[program.actionCount++];
+        action.target = target;
+        action.value = value;
+        while (isspace(*p)) p++;
+        if (*p && *p != ';') return false;
+    }
+    return program.actionCount > 0;
+}
+
+bool RuleEngine::evaluate(const RuleProgram& program, const float* fields, uint32_t validFields) {
+    // In a plain conjunction an unknown field can only make the result
+    // false or unknown
+    uint32_t unknown = program.fieldMask & ~validFields;
+    if (unknown && !program.branches) return false;
+    
+    // Unknown is carried as NAN, known truth values as 0 and 1
+    float stack[MAX_STACK];
+    uint8_t top = 0;
+    const uint8_t* pc = program.code;
+    const uint8_t* end = pc + program.length;
+    
+    while (pc < end) {
+        uint8_t op = *pc++;
+        switch (op) {
+            case OP_FIELD: {
+                uint8_t field = *pc++;
+                stack[top++] = (unknown & FIELD_BIT(field)) ? NAN : fields[field];
+                continue;
+            }
+            case OP_CONST:
+                memcpy(&stack[top++], pc, sizeof(float));
+                pc += sizeof(float);
+                continue;
+            case OP_TEST:
+                if (!isnan(stack[top - 1])) stack[top - 1] = stack[top - 1] > 0;
+                continue;
+            case OP_NOT:
+                if (!isnan(stack[top - 1])) stack[top - 1] = stack[top - 1] == 0;
+                continue;
+            default:
+                break;
+        }
+        
+        // Binary operators
+        float b = stack[--top];
+        float& a = stack[top - 1];
+        switch (op) {
+            case OP_AND:
+                if (a == 0 || b == 0) a = 0;
+                else a = (isnan(a) || isnan(b)) ? NAN : 1;
+                continue;
+            case OP_OR:
+                if ((!isnan(a) && a != 0) || (!isnan(b) && b != 0)) a = 1;
+                else a = (isnan(a) || isnan(b)) ? NAN : 0;
+                continue;
+            default:
+                break;
+        }
+        if (isnan(a) || isnan(b)) {
+            a = NAN;
+            continue;
+        }
+        switch (op) {
+            case OP_LT: a = a < b; break;
+            case OP_LE: a = a <= b; break;
+            case OP_GT: a = a > b; break;
+            case OP_GE: a = a >= b; break;
+            case OP_EQ: a = a == b; break;
+            case OP_NE: a = a != b; break;
+        }
+    }
+    return top == 1 && !isnan(stack[0]) && stack[0] != 0;
+}
+
+void RuleEngine::benchmark(Print& out, int ruleCount) {
+    const int PASSES = 10;
+    const uint32_t ALL_FIELDS = FIELD_BIT(SENSOR_FIELD_COUNT) - 1;
+    
+    // Rules cycle through the compiled samples. Static rather than on the
+    // stack, and only linked in when the benchmark is called.
+    static RuleProgram programs[BENCHMARK_TEMPLATES];
+    char text[RuleProgram::MAX_CODE];
+    for (uint8_t t = 0; t < BENCHMARK_TEMPLATES; t++) {
+        strncpy_P(text, (PGM_P)pgm_read_ptr(&BENCHMARK_RULES[t]), sizeof(text) - 1);
+        text[sizeof(text) - 1] = '\0';
+        compileCondition(text, programs[t]);
+    }
+    
+    float fields[SENSOR_FIELD_COUNT];
+    for (int f = 0; f < SENSOR_FIELD_COUNT; f++) {
+        fields[f] = 10.0 * f;
+    }
+    fields[FIELD_MOTION] = 1.0;
+    fields[FIELD_RAIN] = 0.0;
+    
+    volatile bool sink = false;
+    unsigned long start = micros();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (int r = 0; r < ruleCount; r++) {
+            sink = evaluate(programs[r % BENCHMARK_TEMPLATES], fields, ALL_FIELDS);
+        }
+    }
+    unsigned long compiledTime = (micros() - start) / PASSES;
+    
+    // The old path, text fetched and parsed for every rule
+    RuleProgram scratch;
+    start = micros();
+    for (int r = 0; r < ruleCount; r++) {
+        strncpy_P(text, (PGM_P)pgm_read_ptr(&BENCHMARK_RULES[r % BENCHMARK_TEMPLATES]), sizeof(text) - 1);
+        compileCondition(text, scratch);
+        sink = evaluate(scratch, fields, ALL_FIELDS);
+    }
+    unsigned long parsedTime = micros() - start;
+    (void)sink;
+    
+    out.print(F("Rule engine benchmark, rules: "));
+    out.println(ruleCount);
+    out.print(F("Compiled us/pass: "));
+    out.println(compiledTime);
+    out.print(F("Parsed every pass us/pass: "));
+    out.println(parsedTime);
+    out.print(F("Bytes per rule: "));
+    out.println(sizeof(RuleProgram));
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <Arduino.h>
+#include "sensors.h"
+
+enum RuleActionTarget {
+    RULE_ACTION_FAN,
+    RULE_ACTION_WINDOW,
+    RULE_ACTION_DOOR,
+    RULE_ACTION_LIGHT,
+    RULE_ACTION_LIGHT_MODE,
+    RULE_ACTION_ALARM,
+    RULE_ACTION_BUZZER
+};
+
+struct RuleAction {
+    uint8_t target;
+    int16_t value;
+};
+
+// Compiled form of one rule: the condition as postfix bytecode over
+// SensorField slots and inline constants, the actions as target/value pairs
+struct RuleProgram {
+    static const uint8_t MAX_CODE = 48;
+    static const uint8_t MAX_ACTIONS = 4;
+
+    uint8_t code[MAX_CODE];
+    uint8_t length;
+    RuleAction actions[MAX_ACTIONS];
+    uint8_t actionCount;
+    uint32_t fieldMask;         // SensorField bits the condition reads
+    bool branches;              // Uses || or !, so an unknown field alone doesn't decide it
+};
+
+// Conditions compare sensor fields with numbers (<, <=, >, >=, ==, !=) and
+// combine them with &&, || and !, e.g. "temperature > 28 && !rain". A bare
+// field is true when above zero. Actions are "target=value" pairs separated
+// by ';', e.g. "fan=high; window=50". Text is parsed once by the compile
+// calls; evaluate() is a small stack machine that does not allocate.
+class RuleEngine {
+public:
+    static const uint8_t MAX_STACK = 8;
+
+    static bool compileCondition(const char* text, RuleProgram& program);
+    static bool compileActions(const char* text, RuleProgram& program);
+    // One value per SensorField. Fields missing from validFields are
+    // unknown: comparisons on them and their negations stay unknown, && is
+    // false if either side is false and || true if either side is true,
+    // and an unknown result counts as false. "!rain" does not hold while
+    // the rain sensor is down, "temperature > 50 || gas > 300" still can.
+    static bool evaluate(const RuleProgram& program, const float* fields, uint32_t validFields);
+
+    // Per-pass cost of compiled rules against parsing them every pass
+    static void benchmark(Print& out, int ruleCount = 200);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "security_monitor.h"
+
+static const float GAP_WEIGHT = 0.1;
+static const uint8_t MIN_GAP_SAMPLES = 8;
+static const float GAP_Z_THRESHOLD = 3.0;
+
+SecurityMonitor::SecurityMonitor() : burstThreshold(6), darkLevel(10.0) {
+    clear();
+}
+
+void SecurityMonitor::clear() {
+    events.clear();
+    locationCount = 0;
+    eventCount = 0;
+}
+
+void SecurityMonitor::setBurstThreshold(uint8_t events) {
+    burstThreshold = max(events, (uint8_t)2);
+}
+
+void SecurityMonitor::setDarkLevel(float lux) {
+    darkLevel = lux;
+}
+
+bool SecurityMonitor::record(const SecurityEvent& event) {
+    uint8_t index = locationIndex(event.location);
+    LocationActivity& activity = locations[index];
+    unsigned long now = event.timestamp;
+    
+    // Full ring drops the oldest event
+    SecurityRecord entry = {now, event.lightLevel, index, (uint8_t)constrain(event.severity, 0, 255)};
+    events.push(entry);
+    eventCount++;
+    if (activity.total++ == 0) activity.bucketStart = now;
+    
+    advance(activity, now);
+    if (activity.buckets[activity.head] < 255) {
+        activity.buckets[activity.head]++;
+        activity.windowCount++;
+    }
+    
+    // Gap statistics, z is how much faster than usual this event came
+    float z = 0.0;
+    if (activity.total > 1) {
+        float gap = (now - activity.lastEvent) / 1000.0;
+        if (activity.gapSamples >= MIN_GAP_SAMPLES) {
+            float deviation = sqrt(activity.gapVariance);
+            if (deviation > 0) z = (activity.meanGap - gap) / deviation;
+        }
+        if (activity.gapSamples == 0) {
+            activity.meanGap = gap;
+        } else {
+            float difference = gap - activity.meanGap;
+            activity.meanGap += GAP_WEIGHT * difference;
+            activity.gapVariance = (1.0 - GAP_WEIGHT) * (activity.gapVariance + GAP_WEIGHT * difference * difference);
+        }
+        if (activity.gapSamples < 65535) activity.gapSamples++;
+    }
+    activity.lastEvent = now;
+    
+    uint8_t threshold = event.lightLevel < darkLevel ? max(burstThreshold / 2, 2) : burstThreshold;
+    return activity.windowCount >= threshold ||
+           (z > GAP_Z_THRESHOLD && activity.windowCount >= 2);
+}
+
+void SecurityMonitor::advance(LocationActivity& activity, unsigned long now) {
+    // Expire the buckets that slid out of the window, at most all of them
+    if ((long)(now - activity.bucketStart) < 0) return;
+    unsigned long elapsed = (now - activity.bucketStart) / BUCKET_MS;
+    if (elapsed == 0) return;
+    
+    uint8_t steps = min(elapsed, (unsigned long)WINDOW_BUCKETS);
+    for (uint8_t i = 0; i < steps; i++) {
+        activity.head = (activity.head + 1) % WINDOW_BUCKETS;
+        activity.windowCount -= activity.buckets[activity.head];
+        activity.buckets[activity.head] = 0;
+    }
+    activity.bucketStart += elapsed * BUCKET_MS;
+}
+
+int SecurityMonitor::findLocation(const String& name) const {
+    for (uint8_t i = 0; i < locationCount; i++) {
+        if (locations[i].name == name) return i;
+    }
+    return -1;
+}
+
+uint8_t SecurityMonitor::locationIndex(const String& name) {
+    int index = findLocation(name);
+    if (index >= 0) return index;
+    // Once the table is full, new locations share the last entry
+    if (locationCount == MAX_LOCATIONS) return MAX_LOCATIONS - 1;
+    
+    LocationActivity& activity = locations[locationCount];
+    activity.name = name;
+    memset(activity.buckets, 0, sizeof(activity.buckets));
+    activity.head = 0;
+    activity.bucketStart = 0;
+    activity.windowCount = 0;
+    activity.lastEvent = 0;
+    activity.meanGap = 0.0;
+    activity.gapVariance = 0.0;
+    activity.gapSamples = 0;
+    activity.total = 0;
+    return locationCount++;
+}
+
+int SecurityMonitor::size() const {
+    return events.size();
+}
+
+SecurityRecord SecurityMonitor::event(int index) const {
+    return events[index];
+}
+
+unsigned long SecurityMonitor::totalEvents() const {
+    return eventCount;
+}
+
+int SecurityMonitor::windowCount(const String& location, unsigned long now) {
+    int index = findLocation(location);
+    if (index < 0) return -1;
+    advance(locations[index], now);
+    return locations[index].windowCount;
+}
+
+float SecurityMonitor::meanInterval(const String& location) const {
+    int index = findLocation(location);
+    return index < 0 ? 0.0 : locations[index].meanGap;
+}
+
+void SecurityMonitor::printStats(Print& out) const {
+    out.print(F("Security events: "));
+    out.print(eventCount);
+    out.print(F(", kept: "));
+    out.println(events.size());
+    for (uint8_t i = 0; i < locationCount; i++) {
+        const LocationActivity& activity = locations[i];
+        if (activity.name.length()) {
+            out.print(activity.name);
+        } else {
+            out.print(F("(default)"));
+        }
+        out.print(F(": total "));
+        out.print(activity.total);
+        out.print(F(", window "));
+        out.print(activity.windowCount);
+        out.print(F(", mean gap s "));
+        out.println(activity.meanGap, 1);
+    }
+}
\ No newline at end of file
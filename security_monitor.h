@@ -0,0 +1,83 @@
+#ifndef SECURITY_MONITOR_H
+#define SECURITY_MONITOR_H
+
+#include <Arduino.h>
+#include <CircularBuffer.h>
+
+struct SecurityEvent {
+    unsigned long timestamp;
+    bool motion;
+    float lightLevel;
+    String location;
+    int severity;
+};
+
+// Compact copy of an event kept in the ring, the location is an index
+// into the monitor's location table
+struct SecurityRecord {
+    unsigned long timestamp;
+    float lightLevel;
+    uint8_t location;
+    uint8_t severity;
+};
+
+// Fixed-memory motion log with incremental pattern analysis. Each event
+// updates its location's counters in a bounded number of steps, so the
+// cost per event does not grow with uptime or history length.
+// A location turns suspicious on a burst of events within the window
+// (half as many are needed in the dark), or when events arrive much
+// faster than the location's learned rhythm.
+class SecurityMonitor {
+public:
+    static const uint8_t EVENT_CAPACITY = 32;
+    static const uint8_t MAX_LOCATIONS = 8;
+    static const uint8_t WINDOW_BUCKETS = 10;
+    static const unsigned long BUCKET_MS = 30000UL;     // 5 minute window
+
+    SecurityMonitor();
+
+    // Returns true when the event makes its location's pattern suspicious
+    bool record(const SecurityEvent& event);
+    void clear();
+    void setBurstThreshold(uint8_t events);
+    void setDarkLevel(float lux);
+
+    // Ring queries, index 0 is the oldest event kept
+    int size() const;
+    SecurityRecord event(int index) const;
+    unsigned long totalEvents() const;
+
+    // Events in the window so far, -1 for an unknown location
+    int windowCount(const String& location, unsigned long now);
+    float meanInterval(const String& location) const;      // Seconds
+    void printStats(Print& out) const;
+
+private:
+    // Running activity of one location: event counts over a sliding window
+    // of fixed buckets and an EWMA of the time between events
+    struct LocationActivity {
+        String name;
+        uint8_t buckets[WINDOW_BUCKETS];
+        uint8_t head;
+        unsigned long bucketStart;
+        uint16_t windowCount;
+        unsigned long lastEvent;
+        float meanGap;          // Seconds
+        float gapVariance;
+        uint16_t gapSamples;
+        unsigned long total;
+    };
+
+    CircularBuffer<SecurityRecord, EVENT_CAPACITY> events;
+    LocationActivity locations[MAX_LOCATIONS];
+    uint8_t locationCount;
+    uint8_t burstThreshold;
+    float darkLevel;
+    unsigned long eventCount;
+
+    int findLocation(const String& name) const;
+    uint8_t locationIndex(const String& name);
+    void advance(LocationActivity& activity, unsigned long now);
+};
+
+#endif
\ No newline at end of file
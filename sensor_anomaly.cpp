@@ -0,0 +1,149 @@
+#include "sensor_anomaly.h"
+
+// Scales the MAD to a standard deviation for normally distributed noise
+static const float MAD_TO_SIGMA = 1.4826;
+static const float GLITCH_RATE_WEIGHT = 0.05;
+
+AnomalyDetector::AnomalyDetector(float minScale, float maxRate, float threshold)
+    : minScale(minScale), maxRate(maxRate), threshold(threshold) {
+    reset();
+}
+
+void AnomalyDetector::reset() {
+    head = 0;
+    count = 0;
+    lastValue = 0.0;
+    lastTime = 0;
+    lastScore = 0.0;
+    currentState = ANOMALY_NONE;
+    streak = 0;
+    streakDirection = 0;
+    glitches = 0;
+    eventTime = 0;
+    recentGlitches = 0.0;
+}
+
+AnomalyState AnomalyDetector::add(float value, unsigned long timestamp) {
+    bool anomalous = false;
+    int8_t direction = 0;
+
+    if (count >= MIN_SAMPLES) {
+        float center = median();
+        float scale = max(medianDeviation() * MAD_TO_SIGMA, minScale);
+        lastScore = (value - center) / scale;
+        anomalous = fabs(lastScore) > threshold;
+        direction = value >= center ? 1 : -1;
+
+        // Jumps faster than the physics allows (plus the usual noise) are
+        // suspect even when the window is still noisy enough to hide them
+        if (maxRate > 0) {
+            float minutes = (timestamp - lastTime) / 60000.0;
+            if (fabs(value - lastValue) > maxRate * minutes + threshold * scale) anomalous = true;
+        }
+    }
+
+    recentGlitches *= 1.0 - GLITCH_RATE_WEIGHT;
+    if (anomalous) {
+        if (direction != streakDirection) {
+            endStreak();
+            streakDirection = direction;
+        }
+        if (streak < 255) streak++;
+        currentState = streak >= CONFIRM_SAMPLES ? ANOMALY_SUSTAINED : ANOMALY_GLITCH;
+        if (currentState == ANOMALY_SUSTAINED) eventTime = timestamp;
+    } else {
+        endStreak();
+        currentState = ANOMALY_NONE;
+    }
+
+    // The rate is measured from the last normal sample, so the return from
+    // a spike is not flagged as a second jump
+    insert(value);
+    if (!anomalous) {
+        lastValue = value;
+        lastTime = timestamp;
+    }
+    return currentState;
+}
+
+void AnomalyDetector::endStreak() {
+    // A streak that ended before it was confirmed was a glitch
+    if (streak > 0 && streak < CONFIRM_SAMPLES) {
+        glitches += streak;
+        recentGlitches = min(recentGlitches + GLITCH_RATE_WEIGHT * streak, (float)1.0);
+    }
+    streak = 0;
+    streakDirection = 0;
+}
+
+void AnomalyDetector::insert(float value) {
+    // Drop the oldest value from the sorted copy once the window is full
+    uint8_t size = count;
+    if (count == WINDOW_SIZE) {
+        float oldest = values[head];
+        uint8_t i = 0;
+        while (i < size - 1 && sorted[i] != oldest) i++;
+        for (; i < size - 1; i++) {
+            sorted[i] = sorted[i + 1];
+        }
+        size--;
+    } else {
+        count++;
+    }
+    values[head] = value;
+    head = (head + 1) % WINDOW_SIZE;
+
+    // Insertion step keeps the copy ordered
+    uint8_t i = size;
+    while (i > 0 && sorted[i - 1] > value) {
+        sorted[i] = sorted[i - 1];
+        i--;
+    }
+    sorted[i] = value;
+}
+
+float AnomalyDetector::median() const {
+    return count > 0 ? sorted[count / 2] : 0.0;
+}
+
+float AnomalyDetector::medianDeviation() const {
+    // Deviations from the median come out in ascending order when walking
+    // outwards from the middle of the sorted window
+    uint8_t middle = count / 2;
+    float center = sorted[middle];
+    int lower = middle - 1;
+    int upper = middle + 1;
+    float deviation = 0.0;
+    for (uint8_t k = 0; k < count / 2; k++) {
+        float below = lower >= 0 ? center - sorted[lower] : INFINITY;
+        float above = upper < count ? sorted[upper] - center : INFINITY;
+        if (below <= above) {
+            deviation = below;
+            lower--;
+        } else {
+            deviation = above;
+            upper++;
+        }
+    }
+    return deviation;
+}
+
+AnomalyState AnomalyDetector::state() const {
+    return currentState;
+}
+
+float AnomalyDetector::score() const {
+    return lastScore;
+}
+
+unsigned long AnomalyDetector::glitchCount() const {
+    return glitches;
+}
+
+float AnomalyDetector::glitchRate() const {
+    return recentGlitches;
+}
+
+unsigned long AnomalyDetector::lastEventTime() const {
+    return eventTime;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef SENSOR_ANOMALY_H
+#define SENSOR_ANOMALY_H
+
+#include <Arduino.h>
+
+enum AnomalyState {
+    ANOMALY_NONE,
+    ANOMALY_GLITCH,      // Outlier not (yet) confirmed by following samples
+    ANOMALY_SUSTAINED    // Confirmed excursion, treated as a real event
+};
+
+// Streaming outlier detector for one channel: robust z-score against the
+// median/MAD of a short sliding window plus a rate-of-change limit. An
+// excursion only counts as real once CONFIRM_SAMPLES consecutive samples
+// agree; isolated outliers are glitches and feed the glitch rate.
+// Each sample costs a fixed number of steps bounded by WINDOW_SIZE.
+class AnomalyDetector {
+public:
+    static const uint8_t WINDOW_SIZE = 9;
+    static const uint8_t MIN_SAMPLES = 5;
+    static const uint8_t CONFIRM_SAMPLES = 3;
+
+    // minScale is the smallest meaningful spread (sensor resolution),
+    // maxRate the largest plausible change per minute, 0 disables it
+    AnomalyDetector(float minScale = 0.1, float maxRate = 0, float threshold = 3.5);
+
+    AnomalyState add(float value, unsigned long timestamp);
+    void reset();
+
+    AnomalyState state() const;
+    float score() const;            // Robust z-score of the last sample
+    float median() const;
+    unsigned long glitchCount() const;
+    float glitchRate() const;       // Weighted share of recent samples that were glitches
+    unsigned long lastEventTime() const;   // Latest sample in a sustained excursion
+
+private:
+    float minScale;
+    float maxRate;
+    float threshold;
+
+    float values[WINDOW_SIZE];      // Insertion order
+    float sorted[WINDOW_SIZE];
+    uint8_t head;
+    uint8_t count;
+
+    float lastValue;                // Last sample that was not anomalous
+    unsigned long lastTime;
+    float lastScore;
+    AnomalyState currentState;
+    uint8_t streak;
+    int8_t streakDirection;
+    unsigned long glitches;
+    unsigned long eventTime;
+    float recentGlitches;
+
+    float medianDeviation() const;
+    void insert(float value);
+    void endStreak();
+};
+
+#endif
\ No newline at end of file
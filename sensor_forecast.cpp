@@ -0,0 +1,129 @@
+#include "sensor_forecast.h"
+
+static const float HOUR_MS = 3600000.0;
+static const float STEPS_PER_HOUR = HOUR_MS / SeasonalForecaster::STEP_MS;
+
+SeasonalForecaster::SeasonalForecaster(float alpha, float beta, float gamma)
+    : alpha(alpha), beta(beta), gamma(gamma) {
+    reset();
+}
+
+void SeasonalForecaster::reset() {
+    started = false;
+    initialized = false;
+    steps = 0;
+    levelValue = 0.0;
+    trendValue = 0.0;
+    for (int i = 0; i < SEASON_SLOTS; i++) {
+        season[i] = 0.0;
+    }
+    stepStart = 0;
+    dayPhase = 0;
+    stepSum = 0.0;
+    stepCount = 0;
+}
+
+void SeasonalForecaster::add(float value, unsigned long timestamp) {
+    if (!started) {
+        // The season is relative to the first sample, which is enough for
+        // forecasting since only the 24 h period matters
+        started = true;
+        stepStart = timestamp;
+    }
+
+    unsigned long elapsed = timestamp - stepStart;
+    if (elapsed >= STEP_MS) {
+        closeStep();
+
+        // Steps without samples only carry the trend forward
+        unsigned long skipped = elapsed / STEP_MS - 1;
+        if (skipped > 0) {
+            levelValue += trendValue * skipped;
+            stepStart += skipped * STEP_MS;
+            dayPhase = (dayPhase + (skipped % (DAY_MS / STEP_MS)) * STEP_MS) % DAY_MS;
+        }
+    }
+
+    stepSum += value;
+    stepCount++;
+}
+
+void SeasonalForecaster::closeStep() {
+    unsigned long middle = (dayPhase + STEP_MS / 2) % DAY_MS;
+
+    if (stepCount > 0) {
+        float observed = stepSum / stepCount;
+        float seasonalPart = seasonal(middle);
+
+        if (!initialized) {
+            levelValue = observed - seasonalPart;
+            trendValue = 0.0;
+            initialized = true;
+        } else {
+            float previousLevel = levelValue;
+            levelValue = alpha * (observed - seasonalPart) + (1 - alpha) * (levelValue + trendValue);
+            trendValue = beta * (levelValue - previousLevel) + (1 - beta) * trendValue;
+        }
+        updateSeason(middle, gamma * (observed - levelValue - seasonalPart));
+    } else if (initialized) {
+        levelValue += trendValue;
+    }
+
+    if (initialized && steps < DAY_MS / STEP_MS) steps++;
+    stepStart += STEP_MS;
+    dayPhase = (dayPhase + STEP_MS) % DAY_MS;
+    stepSum = 0.0;
+    stepCount = 0;
+}
+
+void SeasonalForecaster::updateSeason(unsigned long phase, float error) {
+    // Split the correction between the two slots the phase falls between,
+    // then re-center the profile so the level stays the daily mean
+    float position = phase / HOUR_MS - 0.5;
+    if (position < 0) position += SEASON_SLOTS;
+    int first = (int)position;
+    int second = (first + 1) % SEASON_SLOTS;
+    float weight = position - first;
+
+    season[first] += error * (1 - weight);
+    season[second] += error * weight;
+
+    float shift = error / SEASON_SLOTS;
+    for (int i = 0; i < SEASON_SLOTS; i++) {
+        season[i] -= shift;
+    }
+}
+
+float SeasonalForecaster::seasonal(unsigned long phase) const {
+    // Linear interpolation between slot centers
+    float position = (phase % DAY_MS) / HOUR_MS - 0.5;
+    if (position < 0) position += SEASON_SLOTS;
+    int first = (int)position;
+    int second = (first + 1) % SEASON_SLOTS;
+    float weight = position - first;
+    return season[first] * (1 - weight) + season[second] * weight;
+}
+
+bool SeasonalForecaster::isReady() const {
+    // Until every slot has been visited the season is mostly zeros
+    return steps >= DAY_MS / STEP_MS;
+}
+
+float SeasonalForecaster::forecast(float hoursAhead, unsigned long now) const {
+    if (!initialized) return NAN;  // Usable before isReady(), just less accurate
+    if (hoursAhead < 0) hoursAhead = 0;
+
+    // The level describes the middle of the last closed step
+    unsigned long sinceStep = now - stepStart;
+    float stepsAhead = 0.5 + sinceStep / (float)STEP_MS + hoursAhead * STEPS_PER_HOUR;
+    unsigned long target = dayPhase + sinceStep + (unsigned long)(hoursAhead * HOUR_MS);
+    return levelValue + trendValue * stepsAhead + seasonal(target);
+}
+
+float SeasonalForecaster::level() const {
+    return levelValue;
+}
+
+float SeasonalForecaster::trend() const {
+    return trendValue * STEPS_PER_HOUR;
+}
\ No newline at end of file
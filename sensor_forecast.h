@@ -0,0 +1,50 @@
+#ifndef SENSOR_FORECAST_H
+#define SENSOR_FORECAST_H
+
+#include <Arduino.h>
+
+// Additive Holt-Winters forecaster with a daily season. Samples are averaged
+// into fixed steps; each closed step updates level, trend and the seasonal
+// profile in constant time and memory. Forecasts for any horizon are a
+// handful of float operations.
+class SeasonalForecaster {
+public:
+    static const uint8_t SEASON_SLOTS = 24;             // One per hour of the day
+    static const unsigned long STEP_MS = 900000UL;      // 15 minutes
+    static const unsigned long DAY_MS = 86400000UL;
+
+    SeasonalForecaster(float alpha = 0.05, float beta = 0.005, float gamma = 0.3);
+
+    void reset();
+    void add(float value, unsigned long timestamp);
+
+    bool isReady() const;                                // A full season observed
+    float forecast(float hoursAhead, unsigned long now) const;
+
+    float level() const;
+    float trend() const;                                 // Units per hour
+    float seasonal(unsigned long phase) const;           // Offset at a time of day
+
+private:
+    float alpha;
+    float beta;
+    float gamma;
+
+    bool started;
+    bool initialized;
+    uint16_t steps;                     // Closed steps, saturates at a day
+    float levelValue;
+    float trendValue;                   // Units per step
+    float season[SEASON_SLOTS];
+
+    // Open step accumulator, phase is the time of day at stepStart
+    unsigned long stepStart;
+    unsigned long dayPhase;
+    float stepSum;
+    uint16_t stepCount;
+
+    void closeStep();
+    void updateSeason(unsigned long phase, float error);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "sensor_fusion.h"
+
+// Datasheet accuracy of each part, as measurement variance in degC^2
+static const float DHT_TEMP_VARIANCE = 0.25;    // +/-0.5 degC
+static const float BMP_TEMP_VARIANCE = 1.0;     // +/-1.0 degC
+static const float MIN_RELIABILITY = 0.05;
+
+// Process noise: random acceleration of the temperature rate and slow
+// drift of the BMP280 offset, both per hour
+static const float RATE_NOISE = 4.0;
+static const float OFFSET_NOISE = 0.01;
+
+ScalarFilter::ScalarFilter(float processNoise, float initialVariance)
+    : processNoise(processNoise), initialVariance(initialVariance) {
+    reset();
+}
+
+void ScalarFilter::reset() {
+    value = 0;
+    p = initialVariance;
+    initialized = false;
+}
+
+void ScalarFilter::predict(float dtHours) {
+    if (initialized) {
+        p += processNoise * dtHours;
+    }
+}
+
+void ScalarFilter::update(float measurement, float measurementVariance) {
+    if (!initialized) {
+        value = measurement;
+        p = measurementVariance;
+        initialized = true;
+        return;
+    }
+
+    float gain = p / (p + measurementVariance);
+    value += gain * (measurement - value);
+    p *= (1 - gain);
+}
+
+bool ScalarFilter::isInitialized() const {
+    return initialized;
+}
+
+float ScalarFilter::estimate() const {
+    return value;
+}
+
+float ScalarFilter::variance() const {
+    return p;
+}
+
+TemperatureFusion::TemperatureFusion() {
+    reset();
+}
+
+void TemperatureFusion::reset() {
+    for (int i = 0; i < STATES; i++) {
+        x[i] = 0;
+        for (int j = 0; j < STATES; j++) {
+            P[i][j] = 0;
+        }
+    }
+    P[0][0] = 100.0;
+    P[1][1] = 1.0;
+    P[2][2] = 4.0;   // BMP280 usually reads 1-2 degC warm
+    consistency = 1.0;
+    initialized = false;
+}
+
+void TemperatureFusion::predict(float dtHours) {
+    if (!initialized || dtHours <= 0) return;
+
+    // x = F x with F = [[1 dt 0] [0 1 0] [0 0 1]]
+    x[0] += x[1] * dtHours;
+
+    // P = F P F^T
+    for (int j = 0; j < STATES; j++) {
+        P[0][j] += dtHours * P[1][j];
+    }
+    for (int i = 0; i < STATES; i++) {
+        P[i][0] += dtHours * P[i][1];
+    }
+
+    // + Q for a white-noise rate model
+    float dt2 = dtHours * dtHours;
+    P[0][0] += RATE_NOISE * dt2 * dtHours / 3;
+    P[0][1] += RATE_NOISE * dt2 / 2;
+    P[1][0] += RATE_NOISE * dt2 / 2;
+    P[1][1] += RATE_NOISE * dtHours;
+    P[2][2] += OFFSET_NOISE * dtHours;
+}
+
+void TemperatureFusion::updateDHT(float measurement, float reliability) {
+    static const float h[STATES] = {1, 0, 0};
+    float r = DHT_TEMP_VARIANCE / max(reliability, MIN_RELIABILITY);
+
+    if (!initialized) {
+        x[0] = measurement;
+        P[0][0] = r;
+        initialized = true;
+        return;
+    }
+    update(h, measurement, r);
+}
+
+void TemperatureFusion::updateBMP(float measurement, float reliability) {
+    static const float h[STATES] = {1, 0, 1};
+    float r = BMP_TEMP_VARIANCE / max(reliability, MIN_RELIABILITY);
+
+    if (!initialized) {
+        x[0] = measurement - x[2];
+        P[0][0] = r + P[2][2];
+        initialized = true;
+        return;
+    }
+    update(h, measurement, r);
+}
+
+void TemperatureFusion::update(const float h[STATES], float measurement, float measurementVariance) {
+    // Scalar measurement: S = h P h^T + R, K = P h^T / S
+    float Ph[STATES];
+    for (int i = 0; i < STATES; i++) {
+        Ph[i] = 0;
+        for (int j = 0; j < STATES; j++) {
+            Ph[i] += P[i][j] * h[j];
+        }
+    }
+
+    float s = measurementVariance;
+    float predicted = 0;
+    for (int i = 0; i < STATES; i++) {
+        s += h[i] * Ph[i];
+        predicted += h[i] * x[i];
+    }
+
+    float innovation = measurement - predicted;
+    for (int i = 0; i < STATES; i++) {
+        x[i] += Ph[i] / s * innovation;
+    }
+
+    // P = P - K h P, kept symmetric
+    for (int i = 0; i < STATES; i++) {
+        for (int j = i; j < STATES; j++) {
+            P[i][j] -= Ph[i] * Ph[j] / s;
+            P[j][i] = P[i][j];
+        }
+    }
+
+    // Track how well the sensors agree with the model (expected NIS is 1)
+    consistency += 0.1 * (innovation * innovation / s - consistency);
+}
+
+bool TemperatureFusion::isInitialized() const {
+    return initialized;
+}
+
+float TemperatureFusion::temperature() const {
+    return x[0];
+}
+
+float TemperatureFusion::rate() const {
+    return x[1];
+}
+
+float TemperatureFusion::bmpOffset() const {
+    return x[2];
+}
+
+float TemperatureFusion::variance() const {
+    return P[0][0];
+}
+
+float TemperatureFusion::confidence() const {
+    if (!initialized) return 0;
+
+    // Narrow posterior and consistent innovations both raise confidence
+    float spread = 1.0 / (1.0 + sqrt(P[0][0]));
+    float agreement = 1.0 / (1.0 + max(consistency - 1.0, 0.0) / 4.0);
+    return spread * agreement;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include <Arduino.h>
+
+// One-dimensional random-walk Kalman filter for a single measured quantity
+class ScalarFilter {
+public:
+    ScalarFilter(float processNoise = 1.0, float initialVariance = 100.0);
+
+    void reset();
+    void predict(float dtHours);
+    void update(float measurement, float measurementVariance);
+
+    bool isInitialized() const;
+    float estimate() const;
+    float variance() const;
+
+private:
+    float processNoise;     // Variance growth per hour
+    float initialVariance;
+    float value;
+    float p;
+    bool initialized;
+};
+
+// Fuses the DHT and BMP280 temperatures with a fixed 3-state Kalman filter:
+// temperature, its rate of change (per hour) and the BMP280 self-heating
+// offset. Every step is a constant number of 3x3 operations.
+class TemperatureFusion {
+public:
+    static const uint8_t STATES = 3;
+
+    TemperatureFusion();
+
+    void reset();
+    void predict(float dtHours);
+    void updateDHT(float measurement, float reliability);
+    void updateBMP(float measurement, float reliability);
+
+    bool isInitialized() const;
+    float temperature() const;
+    float rate() const;
+    float bmpOffset() const;
+    float variance() const;
+    float confidence() const;   // 0-1 from posterior spread and sensor agreement
+
+private:
+    float x[STATES];
+    float P[STATES][STATES];
+    float consistency;          // Smoothed normalized innovation squared
+    bool initialized;
+
+    void update(const float h[STATES], float measurement, float measurementVariance);
+};
+
+#endif
\ No newline at end of file
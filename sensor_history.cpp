@@ -0,0 +1,162 @@
+#include "sensor_history.h"
+
+SensorHistory::SensorHistory() {
+    clear();
+}
+
+void SensorHistory::add(float value, unsigned long timestamp) {
+    HistorySample entry = {timestamp, value};
+    raw.push(entry);  // Overwrites the oldest sample once full
+
+    // Close the open minute once the new sample falls outside it
+    if (openMinute.count > 0 && timestamp - openMinute.startTime >= MINUTE_MS) {
+        closeMinute();
+    }
+
+    HistoryBucket single = {timestamp, value, value, value, 1};
+    mergeBucket(openMinute, single, MINUTE_MS);
+}
+
+void SensorHistory::clear() {
+    raw.clear();
+    minutes.clear();
+    hours.clear();
+    days.clear();
+    openMinute.count = 0;
+    openHour.count = 0;
+    openDay.count = 0;
+}
+
+void SensorHistory::restore(HistoryResolution resolution, const HistoryBucket& entry) {
+    switch (resolution) {
+        case HISTORY_RAW: {
+            HistorySample sample = {entry.startTime, entry.mean};
+            raw.push(sample);
+            break;
+        }
+        case HISTORY_MINUTE:
+            minutes.push(entry);
+            break;
+        case HISTORY_HOUR:
+            hours.push(entry);
+            break;
+        case HISTORY_DAY:
+            days.push(entry);
+            break;
+    }
+}
+
+void SensorHistory::closeMinute() {
+    minutes.push(openMinute);
+
+    if (openHour.count > 0 && openMinute.startTime - openHour.startTime >= HOUR_MS) {
+        closeHour();
+    }
+    mergeBucket(openHour, openMinute, HOUR_MS);
+    openMinute.count = 0;
+}
+
+void SensorHistory::closeHour() {
+    hours.push(openHour);
+
+    if (openDay.count > 0 && openHour.startTime - openDay.startTime >= DAY_MS) {
+        closeDay();
+    }
+    mergeBucket(openDay, openHour, DAY_MS);
+    openHour.count = 0;
+}
+
+void SensorHistory::closeDay() {
+    days.push(openDay);
+    openDay.count = 0;
+}
+
+void SensorHistory::mergeBucket(HistoryBucket& into, const HistoryBucket& from, unsigned long period) {
+    if (into.count == 0) {
+        into = from;
+        into.startTime = from.startTime - (from.startTime % period);  // Align to period
+        return;
+    }
+
+    if (from.min < into.min) into.min = from.min;
+    if (from.max > into.max) into.max = from.max;
+
+    // Count-weighted running mean
+    unsigned long total = (unsigned long)into.count + from.count;
+    into.mean += (from.mean - into.mean) * from.count / total;
+    into.count = total > 65535UL ? 65535 : total;
+}
+
+int SensorHistory::size(HistoryResolution resolution) const {
+    switch (resolution) {
+        case HISTORY_RAW:
+            return raw.size();
+        case HISTORY_MINUTE:
+            return minutes.size() + (openMinute.count > 0 ? 1 : 0);
+        case HISTORY_HOUR:
+            return hours.size() + (openHour.count > 0 ? 1 : 0);
+        case HISTORY_DAY:
+            return days.size() + (openDay.count > 0 ? 1 : 0);
+    }
+    return 0;
+}
+
+int SensorHistory::closedSize(HistoryResolution resolution) const {
+    switch (resolution) {
+        case HISTORY_RAW:
+            return raw.size();
+        case HISTORY_MINUTE:
+            return minutes.size();
+        case HISTORY_HOUR:
+            return hours.size();
+        case HISTORY_DAY:
+            return days.size();
+    }
+    return 0;
+}
+
+bool SensorHistory::isEmpty() const {
+    return raw.isEmpty();
+}
+
+float SensorHistory::latest() const {
+    return raw.isEmpty() ? NAN : raw.last().value;
+}
+
+unsigned long SensorHistory::latestTime() const {
+    return raw.isEmpty() ? 0 : raw.last().timestamp;
+}
+
+HistorySample SensorHistory::sample(int index) const {
+    return raw[index];
+}
+
+HistoryBucket SensorHistory::bucket(HistoryResolution resolution, int index) const {
+    // The open bucket is exposed as the newest entry so short horizons
+    // are readable before the first period closes
+    switch (resolution) {
+        case HISTORY_RAW: {
+            HistorySample entry = raw[index];
+            HistoryBucket single = {entry.timestamp, entry.value, entry.value, entry.value, 1};
+            return single;
+        }
+        case HISTORY_MINUTE:
+            return index < minutes.size() ? minutes[index] : openMinute;
+        case HISTORY_HOUR:
+            return index < hours.size() ? hours[index] : openHour;
+        case HISTORY_DAY:
+            return index < days.size() ? days[index] : openDay;
+    }
+    return openMinute;
+}
+
+int SensorHistory::copyMeans(HistoryResolution resolution, float* out, int maxCount) const {
+    int available = size(resolution);
+    int count = available < maxCount ? available : maxCount;
+    int first = available - count;
+
+    for (int i = 0; i < count; i++) {
+        out[i] = bucket(resolution, first + i).mean;
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <Arduino.h>
+#include <CircularBuffer.h>
+
+// Resolution tiers kept by SensorHistory
+enum HistoryResolution {
+    HISTORY_RAW,
+    HISTORY_MINUTE,
+    HISTORY_HOUR,
+    HISTORY_DAY
+};
+
+// Single raw reading
+struct HistorySample {
+    unsigned long timestamp;
+    float value;
+};
+
+// Rollup of every sample that fell into one minute/hour/day period
+struct HistoryBucket {
+    unsigned long startTime;
+    float min;
+    float max;
+    float mean;
+    uint16_t count;  // Saturates at 65535, only used to weight the mean
+};
+
+// Fixed-memory time-series store for one sensor channel.
+// Appends are O(1): raw samples go into a ring buffer and are folded into
+// the open minute bucket; closed minutes roll into hours and hours into days.
+class SensorHistory {
+public:
+    static const uint8_t RAW_SIZE = 24;
+    static const uint8_t MINUTE_SIZE = 30;  // Last half hour
+    static const uint8_t HOUR_SIZE = 24;    // Last day
+    static const uint8_t DAY_SIZE = 7;      // Last week
+
+    static const unsigned long MINUTE_MS = 60000UL;
+    static const unsigned long HOUR_MS = 3600000UL;
+    static const unsigned long DAY_MS = 86400000UL;
+
+    SensorHistory();
+
+    void add(float value, unsigned long timestamp);
+    void clear();
+
+    // Append an already aggregated entry, used when importing saved history
+    void restore(HistoryResolution resolution, const HistoryBucket& entry);
+
+    // Queries, index 0 is the oldest entry of the tier
+    int size(HistoryResolution resolution) const;
+    int closedSize(HistoryResolution resolution) const;     // Without the open bucket
+    bool isEmpty() const;
+    float latest() const;
+    unsigned long latestTime() const;
+    HistorySample sample(int index) const;
+    HistoryBucket bucket(HistoryResolution resolution, int index) const;
+
+    // Copy the most recent means of a tier (oldest first) for graphs
+    int copyMeans(HistoryResolution resolution, float* out, int maxCount) const;
+
+private:
+    CircularBuffer<HistorySample, RAW_SIZE> raw;
+    CircularBuffer<HistoryBucket, MINUTE_SIZE> minutes;
+    CircularBuffer<HistoryBucket, HOUR_SIZE> hours;
+    CircularBuffer<HistoryBucket, DAY_SIZE> days;
+
+    // Rollups still being accumulated
+    HistoryBucket openMinute;
+    HistoryBucket openHour;
+    HistoryBucket openDay;
+
+    void closeMinute();
+    void closeHour();
+    void closeDay();
+    static void mergeBucket(HistoryBucket& into, const HistoryBucket& from, unsigned long period);
+};
+
+#endif
\ No newline at end of file
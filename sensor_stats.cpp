@@ -0,0 +1,113 @@
+#include "sensor_stats.h"
+
+ChannelStats::ChannelStats(float smoothing, float trendDecay)
+    : smoothing(smoothing), trendDecay(trendDecay) {
+    reset();
+}
+
+void ChannelStats::reset() {
+    samples = 0;
+    lastValue = NAN;
+    lastTime = 0;
+    average = 0;
+    runningMean = 0;
+    m2 = 0;
+    minHead = minCount = 0;
+    maxHead = maxCount = 0;
+    sumW = sumX = sumY = sumXX = sumXY = 0;
+    valueOrigin = 0;
+}
+
+void ChannelStats::add(float value, unsigned long timestamp) {
+    if (samples == 0) {
+        average = value;
+        valueOrigin = value;
+    } else {
+        average += smoothing * (value - average);
+    }
+
+    // Welford update
+    samples++;
+    float delta = value - runningMean;
+    runningMean += delta / samples;
+    m2 += delta * (value - runningMean);
+
+    // Sliding window extremes
+    pushWindow(minQueue, minHead, minCount, value, true);
+    pushWindow(maxQueue, maxHead, maxCount, value, false);
+
+    // Move the regression origin to the new sample, then decay old weight
+    if (samples > 1) {
+        float dt = (timestamp - lastTime) / 3600000.0;
+        sumXX += dt * (dt * sumW - 2 * sumX);
+        sumXY -= dt * sumY;
+        sumX -= dt * sumW;
+
+        sumW *= trendDecay;
+        sumX *= trendDecay;
+        sumY *= trendDecay;
+        sumXX *= trendDecay;
+        sumXY *= trendDecay;
+    }
+    sumW += 1;
+    sumY += value - valueOrigin;  // x is 0 for the newest sample
+
+    lastValue = value;
+    lastTime = timestamp;
+}
+
+void ChannelStats::pushWindow(WindowEntry* queue, uint8_t& head, uint8_t& count, float value, bool keepMin) {
+    // Expire the front once it leaves the window
+    if (count > 0 && samples - queue[head].sequence >= WINDOW_SIZE) {
+        head = (head + 1) % WINDOW_SIZE;
+        count--;
+    }
+
+    // Drop entries the new value dominates from the back
+    while (count > 0) {
+        float back = queue[(head + count - 1) % WINDOW_SIZE].value;
+        if (keepMin ? back < value : back > value) break;
+        count--;
+    }
+
+    queue[(head + count) % WINDOW_SIZE] = {samples, value};
+    count++;
+}
+
+unsigned long ChannelStats::count() const {
+    return samples;
+}
+
+float ChannelStats::last() const {
+    return lastValue;
+}
+
+float ChannelStats::ewma() const {
+    return samples > 0 ? average : NAN;
+}
+
+float ChannelStats::mean() const {
+    return samples > 0 ? runningMean : NAN;
+}
+
+float ChannelStats::variance() const {
+    return samples > 1 ? m2 / (samples - 1) : 0;
+}
+
+float ChannelStats::stddev() const {
+    return sqrt(variance());
+}
+
+float ChannelStats::windowMin() const {
+    return minCount > 0 ? minQueue[minHead].value : NAN;
+}
+
+float ChannelStats::windowMax() const {
+    return maxCount > 0 ? maxQueue[maxHead].value : NAN;
+}
+
+float ChannelStats::slope() const {
+    float denominator = sumW * sumXX - sumX * sumX;
+    if (samples < 2 || fabs(denominator) < 1e-9) return 0;
+    return (sumW * sumXY - sumX * sumY) / denominator;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef SENSOR_STATS_H
+#define SENSOR_STATS_H
+
+#include <Arduino.h>
+
+// Incremental statistics for one sensor channel. Every update is O(1)
+// (amortized for the window extremes) and every query is a plain read,
+// so averages and trends never trigger extra sampling.
+class ChannelStats {
+public:
+    static const uint8_t WINDOW_SIZE = 16;
+
+    ChannelStats(float smoothing = 0.2, float trendDecay = 0.995);
+
+    void add(float value, unsigned long timestamp);
+    void reset();
+
+    unsigned long count() const;
+    float last() const;
+    float ewma() const;
+    float mean() const;          // Welford running mean
+    float variance() const;      // Welford sample variance
+    float stddev() const;
+    float windowMin() const;     // Over the last WINDOW_SIZE samples
+    float windowMax() const;
+    float slope() const;         // Weighted least-squares trend, units per hour
+
+private:
+    float smoothing;
+    float trendDecay;
+
+    unsigned long samples;
+    float lastValue;
+    unsigned long lastTime;
+
+    // EWMA and Welford accumulators
+    float average;
+    float runningMean;
+    float m2;
+
+    // Monotonic queues of (sequence, value) for the sliding window extremes
+    struct WindowEntry {
+        unsigned long sequence;
+        float value;
+    };
+    WindowEntry minQueue[WINDOW_SIZE];
+    WindowEntry maxQueue[WINDOW_SIZE];
+    uint8_t minHead, minCount;
+    uint8_t maxHead, maxCount;
+
+    // Exponentially weighted regression sums, x in hours relative to the
+    // newest sample and y relative to the first one
+    float sumW, sumX, sumY, sumXX, sumXY;
+    float valueOrigin;
+
+    void pushWindow(WindowEntry* queue, uint8_t& head, uint8_t& count, float value, bool keepMin);
+};
+
+#endif
\ No newline at end of file
@@ -1,195 +1,1354 @@
 #include "sensors.h"
+#include "psychrometrics.h"
 
-void Sensors::begin() {
+// Weight of the newest attempt in the per-sensor error rate
+static const float ERROR_RATE_WEIGHT = 0.1;
+
+// BH1750 in continuous high-resolution mode (set up by its library)
+static const uint8_t BH1750_ADDRESS = 0x23;
+static const float BH1750_COUNTS_PER_LUX = 1.2;
+
+// BMP280 register map
+static const uint8_t BMP280_REG_CALIBRATION = 0x88;
+static const uint8_t BMP280_CALIBRATION_SIZE = 24;
+static const uint8_t BMP280_REG_PRESSURE = 0xF7;   // press_msb .. temp_xlsb
+static const uint8_t BMP280_BURST_SIZE = 6;
+
+// MQ135 CO2 curve, ppm = A * (Rs / R0)^-B, with a 10 kOhm load resistor
+static const float MQ135_CURVE_A = 116.6020682;
+static const float MQ135_CURVE_B = 2.769034857;
+static const float MQ135_LOAD_RESISTANCE = 10.0;
+static const float MQ135_DEFAULT_R0 = 76.63;
+// Concentrations sampled into the air table, denser where the curve bends
+static const int16_t AIR_TABLE_PPM[CalibrationTable::MAX_POINTS] = {
+    10, 50, 100, 200, 400, 600, 1000, 1500, 2500, 4000, 6000, 10000
+};
+
+// GUVA-S12SD module output in mV at UV index 0..11 (datasheet), 5 V ADC
+static const int16_t UV_INDEX_MILLIVOLTS[CalibrationTable::MAX_POINTS] = {
+    50, 227, 318, 408, 503, 606, 696, 795, 881, 976, 1079, 1170
+};
+static const float UV_DEFAULT_DARK_LEVEL = 50 * 1023 / 5000.0;
+static const int UV_TABLE_SCALE = 100;
+static const uint8_t CALIBRATION_SAMPLES = 16;
+
+// Default change-notification limits, in SensorField order
+static const ChangeThreshold DEFAULT_CHANGE_THRESHOLDS[SENSOR_FIELD_COUNT] = {
+    {0.2, 0.1},     // Temperature, C
+    {1.0, 0.5},     // Humidity, %RH
+    {0.5, 0.2},     // Pressure, hPa
+    {5.0, 2.0},     // Altitude, m
+    {0.3, 0.1},     // Dew point, C
+    {0.3, 0.1},     // Heat index, C
+    {0.5, 0.0},     // Motion
+    {10.0, 5.0},    // Light, lux
+    {0.5, 0.0},     // Rain
+    {2.0, 1.0},     // Air quality score
+    {20.0, 10.0},   // CO2, ppm
+    {10.0, 5.0},    // Gas, ppm
+    {5.0, 2.0},     // AQI
+    {2.0, 1.0},     // Soil moisture, %
+    {0.5, 0.2},     // UV index
+    {2.0, 1.0},     // Water level, %
+    {3.0, 1.0},     // Noise, dB
+    {0.3, 0.1}      // Predicted temperature, C
+};
+
+void Sensors::begin(uint8_t airPin) {
+    this->airPin = airPin;
+    
     // Initialize pins with proper pull-up/down resistors
     pinMode(pirPin, INPUT_PULLUP);  // Fix: Add pull-up for reliable motion detection
     pinMode(ldrPin, INPUT);
+    pinMode(airPin, INPUT);
     pinMode(rainPin, INPUT_PULLUP);  // Fix: Add pull-up for reliable rain detection
     pinMode(SOIL_MOISTURE_PIN, INPUT);
     pinMode(UV_SENSOR_PIN, INPUT);
     pinMode(WATER_LEVEL_PIN, INPUT);
     
-    // Fix: Add timeout for sensor initialization
-    unsigned long startTime = millis();
-    bool dhtInitialized = false;
-    while (!dhtInitialized && (millis() - startTime < 2000)) {
-        dhtInitialized = dht.begin();
-        delay(100);
-    }
-    
     Wire.begin();
     
-    // Fix: Add retry mechanism for BH1750
-    bool lightMeterInitialized = false;
-    for (int i = 0; i < 3 && !lightMeterInitialized; i++) {
-        lightMeterInitialized = lightMeter.begin();
-        delay(100);
+    // Devices are brought up by tick(), so begin() never waits on hardware.
+    // Cadences adapt between each part's minimum conversion time (DHT: 2 s)
+    // and a ceiling; the middle value is the starting cadence.
+    bmpAddress = 0x76;
+    initAcquisition(SENSOR_DHT, 2000, 2000, 30000);
+    initAcquisition(SENSOR_LIGHT, 180, 1000, 10000);
+    initAcquisition(SENSOR_PRESSURE, 100, 1000, 30000);
+    initAcquisition(SENSOR_AIR, 500, 2000, 10000);
+    initAcquisition(SENSOR_LDR, 100, 500, 5000);
+    initAcquisition(SENSOR_RAIN, 250, 1000, 10000);
+    initAcquisition(SENSOR_SOIL, 1000, 10000, 300000);
+    initAcquisition(SENSOR_UV, 500, 2000, 60000);
+    initAcquisition(SENSOR_WATER, 1000, 5000, 60000);
+    
+    // Nothing has been reported yet, the first snapshot marks every valid field changed
+    memcpy(changeThresholds, DEFAULT_CHANGE_THRESHOLDS, sizeof(changeThresholds));
+    reportedValid = 0;
+    movingFields = 0;
+    
+    // Anomaly limits: resolution of each channel and the fastest plausible
+    // change per minute (0 where real changes can be instant)
+    tempAnomaly = AnomalyDetector(0.1, 2.0);
+    humidityAnomaly = AnomalyDetector(0.5, 10.0);
+    pressureAnomaly = AnomalyDetector(0.1, 1.0);
+    lightAnomaly = AnomalyDetector(1.0, 0);
+    airAnomaly = AnomalyDetector(2.0, 0);
+    soilAnomaly = AnomalyDetector(4.0, 50.0);
+    uvAnomaly = AnomalyDetector(4.0, 0);
+    waterAnomaly = AnomalyDetector(4.0, 0);
+    memset(&pending, 0, sizeof(pending));
+    published = pending;
+    
+    tempSensorStatus = {false, false, 0, 0};
+    humiditySensorStatus = tempSensorStatus;
+    pressureSensorStatus = tempSensorStatus;
+    lightSensorStatus = tempSensorStatus;
+    clearErrorLog();
+    
+    // Fusion filters, process noise is the expected drift per hour
+    temperatureFusion.reset();
+    humidityFilter = ScalarFilter(25.0, 100.0);
+    pressureFilter = ScalarFilter(1.0, 100.0);
+    fusedDhtTime = 0;
+    fusedBmpTime = 0;
+    lastFusion = {20.0, 50.0, 1013.25, 0.0, millis()};
+    confidenceScore = 0.0;
+    
+    // Reasonable defaults until the first readings arrive
+    lastValidTemperature = 20.0;
+    lastValidHumidity = 50.0;
+    lastValidPressure = 1013.25;
+    lastValidLight = 0.0;
+    
+    // Start with empty history, trends report 0 until enough samples exist
+    clearHistory();
+    
+    // Fix: Initialize calibration values
+    calibration = {0.0, 0.0, 0.0, 0.0, 400.0, 0.0, 0.0, 0.0,
+                   MQ135_DEFAULT_R0, UV_DEFAULT_DARK_LEVEL, millis()};
+    
+    // Perform initial calibration
+    calibrateAllSensors();
+}
+
+void Sensors::initAcquisition(SensorId sensor, unsigned long minInterval, unsigned long interval,
+                              unsigned long maxInterval) {
+    samplers[sensor] = AdaptiveSampler(minInterval, interval, maxInterval);
+    AcquisitionState& state = acquisition[sensor];
+    state.phase = ACQ_INIT;
+    state.started = false;
+    state.interval = interval;
+    state.lastAttempt = millis();
+    state.wait = 0;  // Start on the first tick
+    state.backoff = RETRY_BACKOFF_MS;
+    state.failures = 0;
+}
+
+bool Sensors::tick() {
+    unsigned long now = millis();
+    bool updated = false;
+    
+    // Service every sensor whose slot is due; each step is a single bounded
+    // transaction, retries are rescheduled instead of waited for
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        SensorId sensor = static_cast<SensorId>(i);
+        AcquisitionState& state = acquisition[sensor];
+        if (now - state.lastAttempt < state.wait) continue;
+        state.lastAttempt = now;
+        
+        if (!state.started) {
+            probeSensor(sensor);
+        } else if (readSensor(sensor, now)) {
+            handleAcquisitionSuccess(sensor, now);
+            updated = true;
+        } else {
+            handleAcquisitionFailure(sensor);
+        }
     }
     
-    // Fix: Add proper error handling for BMP280
-    if (!bmp.begin(0x76)) {  // Fix: Add explicit I2C address
-        if (!bmp.begin(0x77)) {  // Try alternate address
-            logError("Could not find BMP280 sensor!");
+    // Publish a consistent snapshot for the getters
+    if (updated) {
+        pending.sequence++;
+        published = pending;
+        updateSensorFusion();
+    }
+    return updated;
+}
+
+bool Sensors::startSensor(SensorId sensor) {
+    switch (sensor) {
+        case SENSOR_DHT:
+            dht.begin();
+            return true;
+        case SENSOR_LIGHT:
+            return lightMeter.begin();
+        case SENSOR_PRESSURE:
+            if (bmp.begin(bmpAddress) && readBmpCalibration()) return true;
+            bmpAddress = (bmpAddress == 0x76) ? 0x77 : 0x76;  // Try alternate address next
+            return false;
+        default:
+            return true;  // Analog inputs need no setup
+    }
+}
+
+bool Sensors::probeSensor(SensorId sensor) {
+    AcquisitionState& state = acquisition[sensor];
+    if (!startSensor(sensor)) {
+        handleAcquisitionFailure(sensor);
+        return false;
+    }
+    state.started = true;
+    state.phase = ACQ_IDLE;
+    state.failures = 0;
+    state.backoff = RETRY_BACKOFF_MS;
+    state.wait = state.interval;  // Let the first conversion complete
+    return true;
+}
+
+bool Sensors::readSensor(SensorId sensor, unsigned long now) {
+    switch (sensor) {
+        case SENSOR_DHT: {
+            float temp = dht.readTemperature();
+            float humidity = dht.readHumidity();  // Served from the same conversion
+            if (isnan(temp) || isnan(humidity)) {
+                logError(SENSOR_DHT, ERROR_READ_FAILED);
+                return false;
+            }
+            if (temp < -40 || temp > 80 || humidity < 0 || humidity > 100) {
+                logError(SENSOR_DHT, ERROR_OUT_OF_RANGE, (temp < -40 || temp > 80) ? temp : humidity);
+                return false;
+            }
+            lastValidTemperature = temp;
+            lastValidHumidity = humidity;
+            pending.temperature = temp;
+            pending.humidity = humidity;
+            updateHistory(temp, tempHistory, tempStats);
+            temperatureForecast.add(temp, now);
+            updateHistory(humidity, humidityHistory, humidityStats);
+            checkAnomaly(tempAnomaly, SENSOR_DHT, temp, now);
+            checkAnomaly(humidityAnomaly, SENSOR_DHT, humidity, now);
+            break;
         }
+        case SENSOR_LIGHT: {
+            float lux;
+            if (!readLightBurst(lux)) {
+                logError(SENSOR_LIGHT, ERROR_READ_FAILED);
+                return false;
+            }
+            lastValidLight = lux;
+            pending.lux = lux;
+            checkAnomaly(lightAnomaly, SENSOR_LIGHT, lux, now);
+            break;
+        }
+        case SENSOR_PRESSURE: {
+            // One burst covers pressure and temperature from the same conversion
+            float bmpTemperature;
+            float pressure;
+            if (!readBmpBurst(bmpTemperature, pressure)) {
+                logError(SENSOR_PRESSURE, ERROR_BUS, bmpAddress);
+                return false;
+            }
+            pressure /= 100.0;  // Pa to hPa
+            if (pressure < 800 || pressure > 1200) {
+                logError(SENSOR_PRESSURE, ERROR_OUT_OF_RANGE, pressure);
+                return false;
+            }
+            lastValidPressure = pressure;
+            pending.pressure = pressure;
+            pending.bmpTemperature = bmpTemperature;
+            updateHistory(pressure, pressureHistory, pressureStats);
+            checkAnomaly(pressureAnomaly, SENSOR_PRESSURE, pressure, now);
+            break;
+        }
+        case SENSOR_AIR:
+            pending.airPPM = airTable.apply(analogRead(airPin));
+            updateHistory(pending.airPPM, airQualityHistory, airQualityStats);
+            checkAnomaly(airAnomaly, SENSOR_AIR, pending.airPPM, now);
+            break;
+        case SENSOR_LDR:
+            pending.ldrRaw = analogRead(ldrPin);
+            break;
+        case SENSOR_RAIN:
+            pending.raining = digitalRead(rainPin) == LOW;  // Active low with pull-up
+            break;
+        case SENSOR_SOIL:
+            pending.soilRaw = analogRead(SOIL_MOISTURE_PIN);
+            checkAnomaly(soilAnomaly, SENSOR_SOIL, pending.soilRaw, now);
+            break;
+        case SENSOR_UV:
+            pending.uvRaw = analogRead(UV_SENSOR_PIN);
+            checkAnomaly(uvAnomaly, SENSOR_UV, pending.uvRaw, now);
+            break;
+        case SENSOR_WATER:
+            pending.waterRaw = analogRead(WATER_LEVEL_PIN);
+            checkAnomaly(waterAnomaly, SENSOR_WATER, pending.waterRaw, now);
+            break;
+        default:
+            return false;
     }
     
-    // Initialize history arrays with valid defaults
-    for (int i = 0; i < HISTORY_SIZE; i++) {
-        tempHistory[i] = 20.0;  // Room temperature default
-        humidityHistory[i] = 50.0;  // Average humidity default
-        pressureHistory[i] = 1013.25;  // Standard pressure default
-        airQualityHistory[i] = 400.0;  // Normal CO2 level default
+    pending.valid[sensor] = true;
+    pending.timestamp[sensor] = now;
+    return true;
+}
+
+bool Sensors::readLightBurst(float& lux) {
+    uint8_t data[2];
+    if (!i2cBus.read(BH1750_ADDRESS, data, sizeof(data))) return false;
+    lux = (((uint16_t)data[0] << 8) | data[1]) / BH1750_COUNTS_PER_LUX;
+    return true;
+}
+
+bool Sensors::readBmpCalibration() {
+    uint8_t data[BMP280_CALIBRATION_SIZE];
+    if (!i2cBus.readRegisters(bmpAddress, BMP280_REG_CALIBRATION, data, sizeof(data))) {
+        return false;
     }
     
-    // Fix: Initialize calibration values
-    calibration = {0.0, 0.0, 0.0, 0.0, 400.0, 0.0, 0.0, 0.0, millis()};
+    // Little-endian words in datasheet order, dig_T1 .. dig_P9
+    uint16_t words[BMP280_CALIBRATION_SIZE / 2];
+    for (int i = 0; i < BMP280_CALIBRATION_SIZE / 2; i++) {
+        words[i] = data[2 * i] | ((uint16_t)data[2 * i + 1] << 8);
+    }
+    bmpCalibration.t1 = words[0];
+    bmpCalibration.t2 = words[1];
+    bmpCalibration.t3 = words[2];
+    bmpCalibration.p1 = words[3];
+    bmpCalibration.p2 = words[4];
+    bmpCalibration.p3 = words[5];
+    bmpCalibration.p4 = words[6];
+    bmpCalibration.p5 = words[7];
+    bmpCalibration.p6 = words[8];
+    bmpCalibration.p7 = words[9];
+    bmpCalibration.p8 = words[10];
+    bmpCalibration.p9 = words[11];
+    return bmpCalibration.p1 != 0;
+}
+
+bool Sensors::readBmpBurst(float& temperature, float& pressure) {
+    uint8_t data[BMP280_BURST_SIZE];
+    if (!i2cBus.readRegisters(bmpAddress, BMP280_REG_PRESSURE, data, sizeof(data))) {
+        return false;
+    }
+    int32_t rawPressure = ((int32_t)data[0] << 12) | ((int32_t)data[1] << 4) | (data[2] >> 4);
+    int32_t rawTemperature = ((int32_t)data[3] << 12) | ((int32_t)data[4] << 4) | (data[5] >> 4);
+    const Bmp280Calibration& c = bmpCalibration;
     
-    // Perform initial calibration
-    calibrateAllSensors();
+    // Integer compensation from the BMP280 datasheet (section 8.2)
+    int32_t var1 = ((((rawTemperature >> 3) - ((int32_t)c.t1 << 1))) * c.t2) >> 11;
+    int32_t var2 = (((((rawTemperature >> 4) - (int32_t)c.t1) * ((rawTemperature >> 4) - (int32_t)c.t1)) >> 12)
+                    * c.t3) >> 14;
+    int32_t fine = var1 + var2;
+    temperature = ((fine * 5 + 128) >> 8) / 100.0;
+    
+    var1 = (fine >> 1) - 64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * c.p6;
+    var2 = var2 + ((var1 * c.p5) << 1);
+    var2 = (var2 >> 2) + ((int32_t)c.p4 << 16);
+    var1 = (((c.p3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((c.p2 * var1) >> 1)) >> 18;
+    var1 = ((32768 + var1) * (int32_t)c.p1) >> 15;
+    if (var1 == 0) return false;  // Avoid division by zero
+    
+    uint32_t p = ((uint32_t)(1048576 - rawPressure) - (var2 >> 12)) * 3125;
+    if (p < 0x80000000) {
+        p = (p << 1) / (uint32_t)var1;
+    } else {
+        p = (p / (uint32_t)var1) * 2;
+    }
+    var1 = ((int32_t)c.p9 * (int32_t)(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(p >> 2) * c.p8) >> 13;
+    pressure = (int32_t)p + ((var1 + var2 + c.p7) >> 4);  // Pa
+    return true;
 }
 
-float Sensors::getTemperature() {
-    // Fix: Add proper error handling and validation
-    float temp = dht.readTemperature();
-    unsigned long startTime = millis();
+void Sensors::handleAcquisitionSuccess(SensorId sensor, unsigned long now) {
+    AcquisitionState& state = acquisition[sensor];
+    state.phase = ACQ_IDLE;
+    state.failures = 0;
+    state.backoff = RETRY_BACKOFF_MS;
+    state.interval = samplers[sensor].update(sampleChange(sensor), now);
+    state.wait = state.interval;
+    errorRate[sensor] *= 1.0 - ERROR_RATE_WEIGHT;
+    recordStatus(sensor, true, now);
+}
+
+void Sensors::handleAcquisitionFailure(SensorId sensor) {
+    AcquisitionState& state = acquisition[sensor];
+    if (state.failures < 255) state.failures++;
+    errorRate[sensor] += ERROR_RATE_WEIGHT * (1.0 - errorRate[sensor]);
     
-    // Retry up to 3 times if reading fails
-    int retries = 0;
-    while (isnan(temp) && retries < 3) {
-        delay(100);
-        temp = dht.readTemperature();
-        retries++;
+    if (state.failures >= MAX_RETRIES) {
+        if (state.phase != ACQ_OFFLINE) {
+            logError(sensor, ERROR_OFFLINE);
+        }
+        state.phase = ACQ_OFFLINE;
+        state.wait = MAX_BACKOFF_MS;
+        pending.valid[sensor] = false;
+    } else {
+        // A device that never came up keeps being probed with startSensor()
+        state.phase = state.started ? ACQ_RETRY : ACQ_INIT;
+        unsigned long minimum = samplers[sensor].minimumInterval();
+        state.wait = max(state.backoff, minimum);
     }
     
-    if (isnan(temp)) {
-        logError("Failed to read temperature");
-        return lastValidTemperature;  // Return last valid reading instead of 0
+    // Exponential backoff for the next retry
+    unsigned long maxBackoff = MAX_BACKOFF_MS;
+    state.backoff = min(state.backoff * 2, maxBackoff);
+    recordStatus(sensor, state.phase != ACQ_OFFLINE, millis());
+}
+
+float Sensors::sampleChange(SensorId sensor) const {
+    // Change since the last published sample, in deadbands (raw counts for
+    // the analog inputs). Called before the new sample is published.
+    if (!published.valid[sensor]) return 1.0;
+    const float ANALOG_STEP = 10.0;
+    switch (sensor) {
+        case SENSOR_DHT:
+            return max(fabs(pending.temperature - published.temperature) / changeThresholds[FIELD_TEMPERATURE].deadband,
+                       fabs(pending.humidity - published.humidity) / changeThresholds[FIELD_HUMIDITY].deadband);
+        case SENSOR_LIGHT:
+            return fabs(pending.lux - published.lux) / changeThresholds[FIELD_LIGHT].deadband;
+        case SENSOR_PRESSURE:
+            return fabs(pending.pressure - published.pressure) / changeThresholds[FIELD_PRESSURE].deadband;
+        case SENSOR_AIR:
+            return fabs(pending.airPPM - published.airPPM) / changeThresholds[FIELD_CO2].deadband;
+        case SENSOR_LDR:
+            return abs(pending.ldrRaw - published.ldrRaw) / ANALOG_STEP;
+        case SENSOR_RAIN:
+            return pending.raining != published.raining ? 1.0 : 0.0;
+        case SENSOR_SOIL:
+            return abs(pending.soilRaw - published.soilRaw) / ANALOG_STEP;
+        case SENSOR_UV:
+            return abs(pending.uvRaw - published.uvRaw) / ANALOG_STEP;
+        case SENSOR_WATER:
+            return abs(pending.waterRaw - published.waterRaw) / ANALOG_STEP;
+        default:
+            return 0.0;
+    }
+}
+
+unsigned long Sensors::readCost(SensorId sensor) const {
+    // Measured I2C time per read where available, typical figures otherwise
+    const I2CDeviceStats* device = nullptr;
+    switch (sensor) {
+        case SENSOR_DHT: return 5000;  // Single-wire frame, blocks for ~5 ms
+        case SENSOR_LIGHT:
+            device = i2cBus.getDeviceStats(BH1750_ADDRESS);
+            return device && device->transfers ? device->busMicros / device->transfers : 250;
+        case SENSOR_PRESSURE:
+            device = i2cBus.getDeviceStats(bmpAddress);
+            return device && device->transfers ? device->busMicros / device->transfers : 300;
+        default: return 112;  // One analogRead conversion
+    }
+}
+
+void Sensors::setUpdateInterval(unsigned long interval) {
+    updateInterval = interval;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        samplers[i].setMaxInterval(interval);
+        acquisition[i].interval = min(acquisition[i].interval, samplers[i].interval());
+    }
+}
+
+void Sensors::setAdaptiveSampling(bool enabled) {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        samplers[i].setAdaptive(enabled);
+        acquisition[i].interval = samplers[i].interval();
+    }
+}
+
+float Sensors::getEffectiveRate(SensorId sensor) const {
+    return samplers[sensor].effectiveRate();
+}
+
+long Sensors::getBusTimeSaved(SensorId sensor) const {
+    return samplers[sensor].samplesSaved(millis()) * (long)readCost(sensor);
+}
+
+static const __FlashStringHelper* sensorName(uint8_t sensor);
+
+void Sensors::printSamplingStats(Print& out) const {
+    long totalSaved = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        SensorId sensor = static_cast<SensorId>(i);
+        long saved = getBusTimeSaved(sensor);
+        totalSaved += saved;
+        out.print(sensorName(sensor));
+        out.print(F(": "));
+        out.print(getEffectiveRate(sensor), 3);
+        out.print(F(" Hz, interval "));
+        out.print(samplers[sensor].interval());
+        out.print(F(" ms, saved "));
+        out.print(saved);
+        out.println(F(" us"));
+    }
+    out.print(F("Bus time saved: "));
+    out.print(totalSaved);
+    out.println(F(" us"));
+}
+
+void Sensors::recordStatus(SensorId sensor, bool working, unsigned long now) {
+    SensorStatus* records[2] = {nullptr, nullptr};
+    switch (sensor) {
+        case SENSOR_DHT:
+            records[0] = &tempSensorStatus;
+            records[1] = &humiditySensorStatus;
+            break;
+        case SENSOR_PRESSURE:
+            records[0] = &pressureSensorStatus;
+            break;
+        case SENSOR_LIGHT:
+            records[0] = &lightSensorStatus;
+            break;
+        default:
+            return;
     }
     
-    // Validate reading
-    if (temp < -40 || temp > 80) {
-        logError("Temperature reading out of range");
-        return lastValidTemperature;
+    for (int i = 0; i < 2 && records[i]; i++) {
+        records[i]->isInitialized = acquisition[sensor].started;
+        records[i]->isWorking = working;
+        if (working) {
+            records[i]->lastReading = now;
+        } else {
+            records[i]->errorCount++;
+        }
     }
+}
+
+bool Sensors::hasReadings() const {
+    return published.sequence > 0;
+}
+
+const SensorReadings& Sensors::getReadings() const {
+    return published;
+}
+
+AcquisitionPhase Sensors::getAcquisitionPhase(SensorId sensor) const {
+    return acquisition[sensor].phase;
+}
+
+void Sensors::updateSensorFusion() {
+    // Measurement variances of the DHT humidity and BMP280 pressure channels
+    const float HUMIDITY_VARIANCE = 4.0;   // +/-2 %RH
+    const float PRESSURE_VARIANCE = 1.0;   // +/-1 hPa
+    const float MIN_RELIABILITY = 0.05;
     
-    lastValidTemperature = temp;  // Update last valid reading
+    unsigned long now = millis();
+    float dtHours = (now - lastFusion.timestamp) / 3600000.0;
+    temperatureFusion.predict(dtHours);
+    humidityFilter.predict(dtHours);
+    pressureFilter.predict(dtHours);
     
-    // Update history with bounds checking
-    if (historyIndex < HISTORY_SIZE) {
-        updateHistory(temp, tempHistory);
+    // Only fold in measurements that are new since the last fusion step
+    if (published.valid[SENSOR_DHT] && published.timestamp[SENSOR_DHT] != fusedDhtTime) {
+        fusedDhtTime = published.timestamp[SENSOR_DHT];
+        float reliability = getSensorReliability(SENSOR_DHT);
+        temperatureFusion.updateDHT(published.temperature, reliability);
+        reliability = max(reliability, MIN_RELIABILITY);
+        humidityFilter.update(published.humidity, HUMIDITY_VARIANCE / reliability);
     }
     
+    if (published.valid[SENSOR_PRESSURE] && published.timestamp[SENSOR_PRESSURE] != fusedBmpTime) {
+        fusedBmpTime = published.timestamp[SENSOR_PRESSURE];
+        float reliability = getSensorReliability(SENSOR_PRESSURE);
+        temperatureFusion.updateBMP(published.bmpTemperature, reliability);
+        pressureFilter.update(published.pressure, PRESSURE_VARIANCE / max(reliability, MIN_RELIABILITY));
+    }
+    
+    if (temperatureFusion.isInitialized()) {
+        lastFusion.temperature = applyCalibration(temperatureFusion.temperature(), calibration.tempOffset);
+    }
+    if (humidityFilter.isInitialized()) {
+        lastFusion.humidity = applyCalibration(humidityFilter.estimate(), calibration.humidityOffset);
+    }
+    if (pressureFilter.isInitialized()) {
+        lastFusion.pressure = applyCalibration(pressureFilter.estimate(), calibration.pressureOffset);
+    }
+    lastFusion.confidence = temperatureFusion.confidence();
+    lastFusion.timestamp = now;
+    confidenceScore = lastFusion.confidence;
+}
+
+SensorFusion Sensors::getFusedEnvironmentalData() {
+    return lastFusion;
+}
+
+float Sensors::getConfidenceScore() {
+    return confidenceScore;
+}
+
+float Sensors::getSensorReliability(SensorId sensor) const {
+    // Trust follows the recent error rate and collapses while offline
+    switch (acquisition[sensor].phase) {
+        case ACQ_INIT: return 0.0;
+        case ACQ_OFFLINE: return 0.1;
+        default: return (1.0 - errorRate[sensor]) * (1.0 - glitchRate(sensor));
+    }
+}
+
+void Sensors::checkAnomaly(AnomalyDetector& detector, SensorId sensor, float value, unsigned long now) {
+    if (detector.add(value, now) == ANOMALY_GLITCH) {
+        logError(sensor, ERROR_GLITCH, value);
+    }
+}
+
+const AnomalyDetector* Sensors::anomalyDetector(SensorField field) const {
+    switch (field) {
+        case FIELD_TEMPERATURE: return &tempAnomaly;
+        case FIELD_HUMIDITY: return &humidityAnomaly;
+        case FIELD_PRESSURE: return &pressureAnomaly;
+        case FIELD_LIGHT: return &lightAnomaly;
+        case FIELD_AIR_QUALITY:
+        case FIELD_CO2:
+        case FIELD_GAS:
+        case FIELD_AQI: return &airAnomaly;
+        case FIELD_SOIL_MOISTURE: return &soilAnomaly;
+        case FIELD_UV: return &uvAnomaly;
+        case FIELD_WATER_LEVEL: return &waterAnomaly;
+        default: return nullptr;
+    }
+}
+
+AnomalyState Sensors::getAnomalyState(SensorField field) const {
+    const AnomalyDetector* detector = anomalyDetector(field);
+    return detector ? detector->state() : ANOMALY_NONE;
+}
+
+float Sensors::glitchRate(SensorId sensor) const {
+    switch (sensor) {
+        case SENSOR_DHT: return max(tempAnomaly.glitchRate(), humidityAnomaly.glitchRate());
+        case SENSOR_PRESSURE: return pressureAnomaly.glitchRate();
+        case SENSOR_LIGHT: return lightAnomaly.glitchRate();
+        case SENSOR_AIR: return airAnomaly.glitchRate();
+        case SENSOR_SOIL: return soilAnomaly.glitchRate();
+        case SENSOR_UV: return uvAnomaly.glitchRate();
+        case SENSOR_WATER: return waterAnomaly.glitchRate();
+        default: return 0.0;
+    }
+}
+
+float Sensors::getSensorReliability(const String& sensorName) {
+    int sensor = sensorIdFromName(sensorName);
+    return sensor < 0 ? 0.0 : getSensorReliability(static_cast<SensorId>(sensor));
+}
+
+bool Sensors::getSensorStatus(const String& sensorName) {
+    int sensor = sensorIdFromName(sensorName);
+    if (sensor < 0) return false;
+    AcquisitionPhase phase = acquisition[sensor].phase;
+    return phase == ACQ_IDLE || phase == ACQ_RETRY;
+}
+
+int Sensors::sensorIdFromName(const String& sensorName) const {
+    if (sensorName == "temperature" || sensorName == "humidity") return SENSOR_DHT;
+    if (sensorName == "light") return SENSOR_LIGHT;
+    if (sensorName == "pressure") return SENSOR_PRESSURE;
+    if (sensorName == "air") return SENSOR_AIR;
+    if (sensorName == "ldr") return SENSOR_LDR;
+    if (sensorName == "rain") return SENSOR_RAIN;
+    if (sensorName == "soil") return SENSOR_SOIL;
+    if (sensorName == "uv") return SENSOR_UV;
+    if (sensorName == "water") return SENSOR_WATER;
+    return -1;
+}
+
+float Sensors::getTemperature() {
+    // Latest published DHT value, never touches the hardware
+    float temp = published.valid[SENSOR_DHT] ? published.temperature : lastValidTemperature;
     return applyCalibration(temp, calibration.tempOffset);
 }
 
 float Sensors::getHumidity() {
-    // Fix: Add proper error handling and validation
-    float humidity = dht.readHumidity();
-    unsigned long startTime = millis();
+    float humidity = published.valid[SENSOR_DHT] ? published.humidity : lastValidHumidity;
+    return applyCalibration(humidity, calibration.humidityOffset);
+}
+
+float Sensors::getPressure() {
+    float pressure = published.valid[SENSOR_PRESSURE] ? published.pressure : lastValidPressure;
+    return applyCalibration(pressure, calibration.pressureOffset);
+}
+
+float Sensors::getPreciseLightLevel() {
+    float lux = published.valid[SENSOR_LIGHT] ? published.lux : lastValidLight;
+    return applyCalibration(lux, calibration.lightOffset);
+}
+
+int Sensors::getLightLevel() {
+    return published.ldrRaw;
+}
+
+bool Sensors::getMotion() {
+    // PIR output is a plain digital level, cheap enough to sample live
+    motionState = digitalRead(pirPin) == HIGH;
+    if (motionState) {
+        lastMotionTime = millis();
+    }
+    return motionState;
+}
+
+bool Sensors::isRaining() {
+    return published.raining;
+}
+
+float Sensors::getCO2Level() {
+    return published.airPPM;
+}
+
+float Sensors::getAirQuality() {
+    return airQualityScore(published.airPPM);
+}
+
+float Sensors::airQualityScore(float ppm) {
+    // 0-100 quality score: baseline CO2 is 100, 2000 ppm above baseline is 0
+    float excess = ppm - calibration.airQualityBaseline;
+    return constrain(100.0 - excess / 20.0, 0.0, 100.0);
+}
+
+float Sensors::getSoilMoisture() {
+    // Capacitive probe reads high when dry
+    return scaleAnalog(published.soilRaw, 100, true, calibration.soilMoistureOffset);
+}
+
+float Sensors::getUVIndex() {
+    // Module response is offset and nonlinear, see buildUVTable
+    return (float)uvTable.apply(published.uvRaw) / UV_TABLE_SCALE + calibration.uvOffset;
+}
+
+float Sensors::getWaterLevel() {
+    return scaleAnalog(published.waterRaw, 100, false, calibration.waterLevelOffset);
+}
+
+static float averageOf(const ChannelStats& stats, int samples, float fallback) {
+    // Smoothed value maintained per sample, no extra reads
+    if (stats.count() == 0) return fallback;
+    return samples <= 1 ? stats.last() : stats.ewma();
+}
+
+float Sensors::getAverageTemperature(int samples) {
+    return applyCalibration(averageOf(tempStats, samples, lastValidTemperature), calibration.tempOffset);
+}
+
+float Sensors::getAverageHumidity(int samples) {
+    return applyCalibration(averageOf(humidityStats, samples, lastValidHumidity), calibration.humidityOffset);
+}
+
+float Sensors::getAveragePressure(int samples) {
+    return applyCalibration(averageOf(pressureStats, samples, lastValidPressure), calibration.pressureOffset);
+}
+
+float Sensors::getAverageAirQuality(int samples) {
+    return airQualityScore(averageOf(airQualityStats, samples, published.airPPM));
+}
+
+float Sensors::getGasLevel() {
+    // Gas concentration above the calibrated clean-air baseline, in ppm
+    float excess = published.airPPM - calibration.airQualityBaseline;
+    return excess > 0 ? excess : 0;
+}
+
+float Sensors::getAltitude() {
+    return calculateAltitude(getPressure());
+}
+
+float Sensors::getDewPoint() {
+    return calculateDewPoint(getTemperature(), getHumidity());
+}
+
+float Sensors::getHeatIndex() {
+    return calculateHeatIndex(getTemperature(), getHumidity());
+}
+
+float Sensors::getAirQualityIndex() {
+    return calculateAirQualityIndex(published.airPPM);
+}
+
+bool Sensors::readSnapshot(SensorData& data) {
+    // Every physical device is read at most once per cycle by tick(); the
+    // snapshot only copies the published values and derives the rest
+    unsigned long now = millis();
+    data.timestamp = now;
+    data.validFields = 0;
+    
+    // Climate fields come from the fusion filters once they hold a measurement
+    data.temperature = temperatureFusion.isInitialized() ? lastFusion.temperature : getTemperature();
+    data.humidity = humidityFilter.isInitialized() ? lastFusion.humidity : getHumidity();
+    setField(data, FIELD_TEMPERATURE, SENSOR_DHT);
+    setField(data, FIELD_HUMIDITY, SENSOR_DHT);
+    
+    data.pressure = pressureFilter.isInitialized() ? lastFusion.pressure : getPressure();
+    data.altitude = calculateAltitude(data.pressure);
+    setField(data, FIELD_PRESSURE, SENSOR_PRESSURE);
+    setField(data, FIELD_ALTITUDE, SENSOR_PRESSURE);
+    
+    data.dewPoint = calculateDewPoint(data.temperature, data.humidity);
+    data.heatIndex = calculateHeatIndex(data.temperature, data.humidity);
+    setDerivedField(data, FIELD_DEW_POINT, FIELD_TEMPERATURE, FIELD_HUMIDITY);
+    setDerivedField(data, FIELD_HEAT_INDEX, FIELD_TEMPERATURE, FIELD_HUMIDITY);
     
-    // Retry up to 3 times if reading fails
-    int retries = 0;
-    while (isnan(humidity) && retries < 3) {
-        delay(100);
-        humidity = dht.readHumidity();
-        retries++;
+    data.lightLevel = getPreciseLightLevel();
+    setField(data, FIELD_LIGHT, SENSOR_LIGHT);
+    
+    data.isRaining = published.raining;
+    setField(data, FIELD_RAIN, SENSOR_RAIN);
+    
+    data.co2Level = published.airPPM;
+    data.airQuality = airQualityScore(published.airPPM);
+    data.gasLevel = getGasLevel();
+    data.airQualityIndex = calculateAirQualityIndex(published.airPPM);
+    setField(data, FIELD_CO2, SENSOR_AIR);
+    setField(data, FIELD_AIR_QUALITY, SENSOR_AIR);
+    setField(data, FIELD_GAS, SENSOR_AIR);
+    setField(data, FIELD_AQI, SENSOR_AIR);
+    
+    data.soilMoisture = getSoilMoisture();
+    data.uvIndex = getUVIndex();
+    data.waterLevel = getWaterLevel();
+    setField(data, FIELD_SOIL_MOISTURE, SENSOR_SOIL);
+    setField(data, FIELD_UV, SENSOR_UV);
+    setField(data, FIELD_WATER_LEVEL, SENSOR_WATER);
+    
+    // Live digital input, always current
+    data.motion = getMotion();
+    data.validFields |= 1UL << FIELD_MOTION;
+    data.fieldTime[FIELD_MOTION] = now;
+    
+    // No sound sensor fitted
+    data.noiseLevel = 0;
+    data.fieldTime[FIELD_NOISE] = 0;
+    
+    // Outliers the detectors have not confirmed yet, and confirmed events
+    data.suspectFields = 0;
+    data.anomalyFields = 0;
+    for (int field = 0; field < SENSOR_FIELD_COUNT; field++) {
+        const AnomalyDetector* detector = anomalyDetector(static_cast<SensorField>(field));
+        if (!detector) continue;
+        if (detector->state() == ANOMALY_GLITCH) {
+            data.suspectFields |= 1UL << field;
+        }
+        if (detector->lastEventTime() != 0 && now - detector->lastEventTime() < ANOMALY_HOLD_MS) {
+            data.anomalyFields |= 1UL << field;
+        }
     }
     
-    if (isnan(humidity)) {
-        logError("Failed to read humidity");
-        return lastValidHumidity;  // Return last valid reading instead of 0
+    // Look-ahead for pre-conditioning, valid once a full day has been learned
+    data.predictedTemperature = getPredictedTemperature(FORECAST_LOOKAHEAD_HOURS);
+    data.fieldTime[FIELD_PREDICTED_TEMPERATURE] = published.timestamp[SENSOR_DHT];
+    if (temperatureForecast.isReady() && (data.validFields & (1UL << FIELD_TEMPERATURE))) {
+        data.validFields |= 1UL << FIELD_PREDICTED_TEMPERATURE;
     }
     
-    // Validate reading
-    if (humidity < 0 || humidity > 100) {
-        logError("Humidity reading out of range");
-        return lastValidHumidity;
+    updateChangedFields(data);
+    
+    // Fails only when no acquired device has a valid reading, check
+    // hasReadings() first to tell this apart from the start-up period
+    return (data.validFields & ~(1UL << FIELD_MOTION)) != 0;
+}
+
+void Sensors::setField(SensorData& data, SensorField field, SensorId source) {
+    data.fieldTime[field] = published.timestamp[source];
+    if (published.valid[source]) {
+        data.validFields |= 1UL << field;
+    }
+}
+
+void Sensors::setDerivedField(SensorData& data, SensorField field, SensorField first, SensorField second) {
+    // Derived values are as old as their oldest input
+    unsigned long firstTime = data.fieldTime[first];
+    unsigned long secondTime = data.fieldTime[second];
+    data.fieldTime[field] = (long)(firstTime - secondTime) < 0 ? firstTime : secondTime;
+    if (isFieldValid(data, first) && isFieldValid(data, second)) {
+        data.validFields |= 1UL << field;
+    }
+}
+
+bool Sensors::isFieldValid(const SensorData& data, SensorField field) const {
+    return (data.validFields & (1UL << field)) != 0;
+}
+
+float Sensors::getFieldValue(const SensorData& data, SensorField field) const {
+    switch (field) {
+        case FIELD_TEMPERATURE: return data.temperature;
+        case FIELD_HUMIDITY: return data.humidity;
+        case FIELD_PRESSURE: return data.pressure;
+        case FIELD_ALTITUDE: return data.altitude;
+        case FIELD_DEW_POINT: return data.dewPoint;
+        case FIELD_HEAT_INDEX: return data.heatIndex;
+        case FIELD_MOTION: return data.motion ? 1.0 : 0.0;
+        case FIELD_LIGHT: return data.lightLevel;
+        case FIELD_RAIN: return data.isRaining ? 1.0 : 0.0;
+        case FIELD_AIR_QUALITY: return data.airQuality;
+        case FIELD_CO2: return data.co2Level;
+        case FIELD_GAS: return data.gasLevel;
+        case FIELD_AQI: return data.airQualityIndex;
+        case FIELD_SOIL_MOISTURE: return data.soilMoisture;
+        case FIELD_UV: return data.uvIndex;
+        case FIELD_WATER_LEVEL: return data.waterLevel;
+        case FIELD_NOISE: return data.noiseLevel;
+        case FIELD_PREDICTED_TEMPERATURE: return data.predictedTemperature;
+        default: return NAN;
+    }
+}
+
+void Sensors::setChangeThreshold(SensorField field, float deadband, float hysteresis) {
+    changeThresholds[field].deadband = deadband;
+    changeThresholds[field].hysteresis = min(hysteresis, deadband);
+}
+
+void Sensors::updateChangedFields(SensorData& data) {
+    // A quiet field is reported once it leaves the deadband around its last
+    // reported value. While it keeps moving the band shrinks by the
+    // hysteresis, so a ramp is followed closely and noise around a steady
+    // value is not.
+    data.changedFields = 0;
+    for (int field = 0; field < SENSOR_FIELD_COUNT; field++) {
+        uint32_t bit = FIELD_BIT(field);
+        bool valid = (data.validFields & bit) != 0;
+        float value = getFieldValue(data, static_cast<SensorField>(field));
+        
+        if (valid != ((reportedValid & bit) != 0)) {
+            // Gaining or losing a reading is always a change
+            data.changedFields |= bit;
+            reportedValid ^= bit;
+            reportedValue[field] = value;
+            movingFields &= ~bit;
+            continue;
+        }
+        if (!valid) continue;
+        
+        const ChangeThreshold& threshold = changeThresholds[field];
+        float band = threshold.deadband - ((movingFields & bit) ? threshold.hysteresis : 0);
+        if (fabs(value - reportedValue[field]) > band) {
+            data.changedFields |= bit;
+            reportedValue[field] = value;
+            movingFields |= bit;
+        } else {
+            movingFields &= ~bit;
+        }
     }
     
-    lastValidHumidity = humidity;  // Update last valid reading
+    // Confirmed anomalies keep their subscribers running for the hold time
+    data.changedFields |= data.anomalyFields;
+}
+
+unsigned long Sensors::getFieldAge(const SensorData& data, SensorField field) const {
+    return data.timestamp - data.fieldTime[field];
+}
+
+float Sensors::calculateDewPoint(float temperature, float humidity) {
+    return Psychrometrics::dewPoint(temperature, humidity);
+}
+
+float Sensors::calculateHeatIndex(float temperature, float humidity) {
+    return Psychrometrics::heatIndex(temperature, humidity);
+}
+
+float Sensors::applyCalibration(float value, float offset) {
+    return value + offset;
+}
+
+float Sensors::scaleAnalog(int raw, int span, bool inverted, float offset) {
+    // Map a 10-bit ADC count onto 0..span and apply the calibration offset
+#ifdef SENSORS_FIXED_POINT
+    // Integer quotient and remainder keep raw * span / 1023 inside 32 bits
+    int32_t product = (int32_t)raw * span;
+    fix16_t scaled = fix16FromInt(product / 1023) + (fix16_t)(((product % 1023) << 16) / 1023);
+    if (inverted) scaled = fix16FromInt(span) - scaled;
+    return fix16ToFloat(scaled) + offset;
+#else
+    float scaled = raw * span / 1023.0;
+    if (inverted) scaled = span - scaled;
+    return scaled + offset;
+#endif
+}
+
+static int averageAnalog(uint8_t pin) {
+    long total = 0;
+    for (uint8_t i = 0; i < CALIBRATION_SAMPLES; i++) {
+        total += analogRead(pin);
+    }
+    return total / CALIBRATION_SAMPLES;
+}
+
+void Sensors::calibrateAllSensors() {
+    // Rebuild the lookup tables from the stored parameters; sampling in
+    // reference conditions is left to the per-sensor calls, the MQ135
+    // needs a long warm-up before its clean-air resistance means anything
+    buildAirTable();
+    buildUVTable();
+    calibration.lastCalibration = millis();
+}
+
+void Sensors::calibrateAirSensor() {
+    // Expects the sensor warmed up in clean air at the baseline concentration
+    int raw = averageAnalog(airPin);
+    if (raw <= 0 || raw >= 1023) {
+        logError(SENSOR_AIR, ERROR_OUT_OF_RANGE, raw);
+        return;
+    }
+    float resistance = (1023.0 / raw - 1.0) * MQ135_LOAD_RESISTANCE;
+    calibration.airResistance = resistance * pow(calibration.airQualityBaseline / MQ135_CURVE_A,
+                                                 1.0 / MQ135_CURVE_B);
+    buildAirTable();
+    calibration.lastCalibration = millis();
+}
+
+void Sensors::calibrateUVSensor() {
+    // Expects the sensor covered; anything above UV index 1 is not dark
+    int raw = averageAnalog(UV_SENSOR_PIN);
+    if (raw >= UV_INDEX_MILLIVOLTS[1] * 1023L / 5000) {
+        logError(SENSOR_UV, ERROR_OUT_OF_RANGE, raw);
+        return;
+    }
+    calibration.uvDarkLevel = raw;
+    buildUVTable();
+    calibration.lastCalibration = millis();
+}
+
+void Sensors::setSensorCalibration(const SensorCalibration& calibration) {
+    this->calibration = calibration;
+    buildAirTable();
+    buildUVTable();
+}
+
+void Sensors::buildAirTable() {
+    // Invert the power-law curve at fixed concentrations; readings then
+    // interpolate between ADC counts instead of calling pow() each time
+    airTable.clear();
+    for (uint8_t i = 0; i < CalibrationTable::MAX_POINTS; i++) {
+        float ratio = pow(AIR_TABLE_PPM[i] / MQ135_CURVE_A, -1.0 / MQ135_CURVE_B);
+        float resistance = calibration.airResistance * ratio;
+        int16_t raw = (int16_t)(1023.0 / (resistance / MQ135_LOAD_RESISTANCE + 1.0) + 0.5);
+        airTable.addPoint(raw, AIR_TABLE_PPM[i]);
+    }
+}
+
+void Sensors::buildUVTable() {
+    // Datasheet response shifted to the measured dark level
+    float shift = calibration.uvDarkLevel - UV_DEFAULT_DARK_LEVEL;
+    uvTable.clear();
+    for (uint8_t i = 0; i < CalibrationTable::MAX_POINTS; i++) {
+        float raw = UV_INDEX_MILLIVOLTS[i] * 1023 / 5000.0 + shift;
+        uvTable.addPoint((int16_t)(raw + 0.5), i * UV_TABLE_SCALE);
+    }
+}
+
+float Sensors::calculateAltitude(float pressure) {
+    // International barometric formula against standard sea level pressure
+    return 44330.0 * (1.0 - pow(pressure / 1013.25, 0.1903));
+}
+
+float Sensors::calculateAirQualityIndex(float ppm) {
+    // Piecewise linear CO2 to 0-500 index: 400 ppm clean, 5000 ppm hazardous
+    if (ppm <= 400) return 0;
+    if (ppm <= 1000) return (ppm - 400) / 6.0;            // 0-100
+    if (ppm <= 2000) return 100 + (ppm - 1000) / 10.0;    // 100-200
+    if (ppm <= 5000) return 200 + (ppm - 2000) / 10.0;    // 200-500
+    return 500;
+}
+
+void Sensors::updateHistory(float value, SensorHistory& history, ChannelStats& stats) {
+    // Constant-time append, rollups and statistics are maintained incrementally
+    unsigned long now = millis();
+    history.add(value, now);
+    stats.add(value, now);
+}
+
+float Sensors::calculateTrend(const SensorHistory& history, HistoryResolution resolution) {
+    // Least-squares slope of the tier means, in units per hour
+    int count = history.size(resolution);
+    if (count < 2) return 0.0;
     
-    // Update history with bounds checking
-    if (historyIndex < HISTORY_SIZE) {
-        updateHistory(humidity, humidityHistory);
+    unsigned long origin = history.bucket(resolution, 0).startTime;
+    float sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (int i = 0; i < count; i++) {
+        HistoryBucket entry = history.bucket(resolution, i);
+        float x = (entry.startTime - origin) / 3600000.0;
+        sumX += x;
+        sumY += entry.mean;
+        sumXY += x * entry.mean;
+        sumXX += x * x;
     }
     
-    return applyCalibration(humidity, calibration.humidityOffset);
+    float denominator = count * sumXX - sumX * sumX;
+    if (denominator == 0) return 0.0;
+    return (count * sumXY - sumX * sumY) / denominator;
 }
 
-void Sensors::updateHistory(float value, float history[]) {
-    // Fix: Add proper bounds checking
-    if (historyIndex >= HISTORY_SIZE) {
-        // Shift array to make room for new value
-        for (int i = 0; i < HISTORY_SIZE - 1; i++) {
-            history[i] = history[i + 1];
+static HistoryResolution trendResolution(const SensorHistory& history) {
+    // Prefer the minute tier once it spans a few points, raw samples before that
+    return history.size(HISTORY_MINUTE) >= 3 ? HISTORY_MINUTE : HISTORY_RAW;
+}
+
+float Sensors::getTemperatureTrend() {
+    return tempStats.slope();
+}
+
+float Sensors::getHumidityTrend() {
+    return humidityStats.slope();
+}
+
+float Sensors::getPressureTrend() {
+    return pressureStats.slope();
+}
+
+float Sensors::getAirQualityTrend() {
+    return airQualityStats.slope();
+}
+
+float Sensors::predictValue(const SensorHistory& history, float hoursAhead) {
+    if (history.isEmpty()) return NAN;
+    
+    // Extrapolate along the longest horizon that has enough points
+    HistoryResolution resolution = history.size(HISTORY_HOUR) >= 3 ? HISTORY_HOUR : trendResolution(history);
+    return history.latest() + calculateTrend(history, resolution) * hoursAhead;
+}
+
+float Sensors::getPredictedTemperature(float hoursAhead) {
+    // Seasonal forecast once a full day is learned, trend extrapolation before
+    float predicted = temperatureForecast.isReady()
+        ? temperatureForecast.forecast(hoursAhead, millis())
+        : predictValue(tempHistory, hoursAhead);
+    return applyCalibration(isnan(predicted) ? lastValidTemperature : predicted, calibration.tempOffset);
+}
+
+const SensorHistory& Sensors::getTemperatureHistory() const {
+    return tempHistory;
+}
+
+const SensorHistory& Sensors::getHumidityHistory() const {
+    return humidityHistory;
+}
+
+const SensorHistory& Sensors::getPressureHistory() const {
+    return pressureHistory;
+}
+
+const SensorHistory& Sensors::getAirQualityHistory() const {
+    return airQualityHistory;
+}
+
+const ChannelStats& Sensors::getTemperatureStats() const {
+    return tempStats;
+}
+
+const ChannelStats& Sensors::getHumidityStats() const {
+    return humidityStats;
+}
+
+const ChannelStats& Sensors::getPressureStats() const {
+    return pressureStats;
+}
+
+const ChannelStats& Sensors::getAirQualityStats() const {
+    return airQualityStats;
+}
+
+// Channels kept in the exported history, in file order
+static const uint8_t HISTORY_CHANNELS[] = {FIELD_TEMPERATURE, FIELD_HUMIDITY, FIELD_PRESSURE, FIELD_CO2};
+static const uint8_t HISTORY_CHANNEL_COUNT = sizeof(HISTORY_CHANNELS);
+
+static void exportHistory(TimeSeriesEncoder& encoder, uint8_t channel, const SensorHistory& history,
+                          unsigned long now) {
+    for (int r = HISTORY_RAW; r <= HISTORY_DAY; r++) {
+        HistoryResolution resolution = static_cast<HistoryResolution>(r);
+        int count = history.closedSize(resolution);
+        if (count == 0) continue;
+        
+        // Closed periods only, stored by age since millis() restarts on
+        // reboot. Raw samples carry no min/max, rollups keep their range.
+        encoder.beginSeries(channel, resolution, resolution != HISTORY_RAW);
+        for (int i = 0; i < count; i++) {
+            HistoryBucket entry = history.bucket(resolution, i);
+            TimeSeriesPoint point = {now - entry.startTime, entry.mean, entry.min, entry.max, entry.count};
+            encoder.add(point);
         }
-        historyIndex = HISTORY_SIZE - 1;
     }
-    
-    history[historyIndex++] = value;
 }
 
-bool Sensors::performSelfTest() {
-    bool success = true;
+void Sensors::exportData(Print& out) {
+    // Blocks are written as they fill, nothing is materialized in RAM
+    TimeSeriesEncoder encoder(out);
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        exportHistory(encoder, HISTORY_CHANNELS[i], *historyForChannel(HISTORY_CHANNELS[i]), now);
+    }
+    encoder.finish();
+}
+
+static bool validateHistory(Stream& in) {
+    // Decode-only pass, checks every block CRC and payload bound
+    TimeSeriesDecoder decoder(in);
+    TimeSeriesPoint point;
+    while (decoder.readBlock()) {
+        while (decoder.next(point)) {}
+    }
+    return !decoder.isCorrupt();
+}
+
+bool Sensors::importData(Stream& in, StreamRewind rewind, void* context) {
+    // A corrupt file leaves the history as it was
+    if (!validateHistory(in)) {
+        logError(SENSOR_COUNT, ERROR_IMPORT_CORRUPT);
+        return false;
+    }
+    if (!rewind(context)) return false;
     
-    // Fix: Add comprehensive sensor testing
-    // Test temperature sensor
-    float temp = getTemperature();
-    if (isnan(temp) || temp < -40 || temp > 80) {
-        logError("Temperature sensor failure");
-        success = false;
+    for (uint8_t i = 0; i < HISTORY_CHANNEL_COUNT; i++) {
+        historyForChannel(HISTORY_CHANNELS[i])->clear();
     }
     
-    // Test humidity sensor
-    float humidity = getHumidity();
-    if (isnan(humidity) || humidity < 0 || humidity > 100) {
-        logError("Humidity sensor failure");
-        success = false;
+    unsigned long now = millis();
+    TimeSeriesDecoder decoder(in);
+    TimeSeriesPoint point;
+    while (decoder.readBlock()) {
+        SensorHistory* history = historyForChannel(decoder.blockChannel());
+        uint8_t resolution = decoder.blockResolution();
+        while (decoder.next(point)) {
+            if (!history || resolution > HISTORY_DAY) continue;  // Unknown series
+            HistoryBucket entry = {now - point.timestamp, point.min, point.max, point.value, point.count};
+            history->restore(static_cast<HistoryResolution>(resolution), entry);
+        }
     }
     
-    // Test pressure sensor
-    float pressure = getPressure();
-    if (isnan(pressure) || pressure < 800 || pressure > 1200) {
-        logError("Pressure sensor failure");
-        success = false;
+    if (decoder.isCorrupt()) {
+        // The stream changed between the passes
+        logError(SENSOR_COUNT, ERROR_IMPORT_CORRUPT);
+        return false;
+    }
+    return true;
+}
+
+SensorHistory* Sensors::historyForChannel(uint8_t channel) {
+    switch (channel) {
+        case FIELD_TEMPERATURE: return &tempHistory;
+        case FIELD_HUMIDITY: return &humidityHistory;
+        case FIELD_PRESSURE: return &pressureHistory;
+        case FIELD_CO2: return &airQualityHistory;
+        default: return nullptr;
     }
+}
+
+void Sensors::clearHistory() {
+    tempHistory.clear();
+    humidityHistory.clear();
+    pressureHistory.clear();
+    airQualityHistory.clear();
+    tempStats.reset();
+    humidityStats.reset();
+    pressureStats.reset();
+    airQualityStats.reset();
+    temperatureForecast.reset();
+}
+
+bool Sensors::performSelfTest() {
+    bool success = true;
     
-    // Test light sensor
-    float light = getPreciseLightLevel();
-    if (isnan(light) || light < 0) {
-        logError("Light sensor failure");
-        success = false;
+    // Judge devices by their acquisition state instead of forcing reads;
+    // sensors that have not reported yet are not counted as failures.
+    // Offline devices are restarted here so a recovered one rejoins the
+    // acquisition cycle.
+    const SensorId CHECKED[] = {SENSOR_DHT, SENSOR_PRESSURE, SENSOR_LIGHT};
+    for (uint8_t i = 0; i < sizeof(CHECKED) / sizeof(CHECKED[0]); i++) {
+        AcquisitionState& state = acquisition[CHECKED[i]];
+        if (state.phase != ACQ_OFFLINE) continue;
+        state.lastAttempt = millis();
+        if (!probeSensor(CHECKED[i])) {
+            logError(CHECKED[i], ERROR_SELF_TEST);
+            success = false;
+        }
     }
     
     // Fix: Add I2C bus check
-    Wire.beginTransmission(0x76);  // BMP280 address
-    if (Wire.endTransmission() != 0) {
-        logError("I2C communication failure");
+    if (!i2cBus.probe(bmpAddress)) {
+        logError(SENSOR_PRESSURE, ERROR_BUS, bmpAddress);
         success = false;
     }
     
     return success;
 }
 
-void Sensors::logError(const String& error) {
-    // Fix: Add timestamp and error count management
-    String timestamp = String(millis());
-    String logEntry = "[" + timestamp + "] " + error + "\n";
-    
-    // Prevent error log from growing too large
-    if (errorLog.length() > 1000) {
-        // Remove oldest entry
-        int firstNewline = errorLog.indexOf('\n');
-        if (firstNewline != -1) {
-            errorLog = errorLog.substring(firstNewline + 1);
+void Sensors::logError(uint8_t sensor, SensorErrorCode code, float value) {
+    // Fixed-size record, the ring drops the oldest entry when full
+    ErrorRecord record = {millis(), value, sensor, static_cast<uint8_t>(code)};
+    errorLog.push(record);
+    errorCount++;
+    if (sensor < SENSOR_COUNT && sensorErrors[sensor] < 0xFFFF) {
+        sensorErrors[sensor]++;
+    }
+}
+
+static const __FlashStringHelper* sensorName(uint8_t sensor) {
+    switch (sensor) {
+        case SENSOR_DHT: return F("DHT");
+        case SENSOR_LIGHT: return F("light");
+        case SENSOR_PRESSURE: return F("BMP280");
+        case SENSOR_AIR: return F("MQ135");
+        case SENSOR_LDR: return F("LDR");
+        case SENSOR_RAIN: return F("rain");
+        case SENSOR_SOIL: return F("soil");
+        case SENSOR_UV: return F("UV");
+        case SENSOR_WATER: return F("water");
+        default: return F("system");
+    }
+}
+
+static const __FlashStringHelper* errorMessage(uint8_t code) {
+    switch (code) {
+        case ERROR_READ_FAILED: return F("read failed");
+        case ERROR_OUT_OF_RANGE: return F("reading out of range");
+        case ERROR_OFFLINE: return F("offline after retries");
+        case ERROR_SELF_TEST: return F("self-test failure");
+        case ERROR_BUS: return F("I2C communication failure");
+        case ERROR_IMPORT_CORRUPT: return F("history import failed CRC check");
+        case ERROR_GLITCH: return F("outlier reading");
+        default: return F("unknown error");
+    }
+}
+
+void Sensors::getErrorLog(Print& out) const {
+    // Same "[millis] message" lines as before, built only on request
+    for (int i = 0; i < errorLog.size(); i++) {
+        ErrorRecord record = errorLog[i];
+        out.print('[');
+        out.print(record.timestamp);
+        out.print(F("] "));
+        out.print(sensorName(record.sensor));
+        out.print(' ');
+        out.print(errorMessage(record.code));
+        if (!isnan(record.value)) {
+            out.print(F(": "));
+            out.print(record.value, 2);
         }
+        out.println();
     }
-    
-    errorLog += logEntry;
-    errorCount++;
-    
-    // Reset error count periodically to prevent overflow
-    if (errorCount > 1000) {
-        errorCount = 1;
+}
+
+int Sensors::getErrorLogSize() const {
+    return errorLog.size();
+}
+
+ErrorRecord Sensors::getErrorRecord(int index) const {
+    return errorLog[index];
+}
+
+void Sensors::clearErrorLog() {
+    errorLog.clear();
+    errorCount = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        sensorErrors[i] = 0;
+        errorRate[i] = 0.0;
     }
+}
+
+unsigned long Sensors::getErrorCount() const {
+    return errorCount;
+}
+
+uint16_t Sensors::getErrorCount(SensorId sensor) const {
+    return sensorErrors[sensor];
+}
+
+float Sensors::getErrorRate(SensorId sensor) const {
+    return errorRate[sensor];
 }
\ No newline at end of file
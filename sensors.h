@@ -6,12 +6,25 @@
 #include <Wire.h>
 #include <BH1750.h>
 #include <Adafruit_BMP280.h>
-#include <MQ135.h>
-#include <CircularBuffer.h>
+#include "sensor_history.h"
+#include "sensor_stats.h"
+#include "sensor_fusion.h"
+#include "sensor_forecast.h"
+#include "sensor_anomaly.h"
+#include "timeseries_codec.h"
+#include "i2c_bus.h"
+#include "adaptive_sampler.h"
+#include "calibration_table.h"
 
 // Fix: Add proper version control
 #define SENSORS_VERSION "1.0.1"
 
+// How long a confirmed anomaly stays flagged in SensorData
+#define ANOMALY_HOLD_MS 30000
+
+// Horizon of the temperature forecast carried in SensorData
+#define FORECAST_LOOKAHEAD_HOURS 1.0
+
 // Enhanced sensor calibration structure
 struct SensorCalibration {
     float tempOffset;
@@ -22,6 +35,8 @@ struct SensorCalibration {
     float uvOffset;
     float soilMoistureOffset;
     float waterLevelOffset;
+    float airResistance;      // MQ135 R0 in clean air, kOhm
+    float uvDarkLevel;        // UV module output in the dark, ADC counts
     unsigned long lastCalibration;
 };
 
@@ -50,6 +65,152 @@ struct SensorFusion {
     unsigned long timestamp;
 };
 
+// Physical sensors serviced by the acquisition engine
+enum SensorId {
+    SENSOR_DHT,       // Temperature and humidity
+    SENSOR_LIGHT,     // BH1750
+    SENSOR_PRESSURE,  // BMP280
+    SENSOR_AIR,       // MQ135
+    SENSOR_LDR,
+    SENSOR_RAIN,
+    SENSOR_SOIL,
+    SENSOR_UV,
+    SENSOR_WATER,
+    SENSOR_COUNT
+};
+
+enum AcquisitionPhase {
+    ACQ_INIT,     // Device not brought up yet
+    ACQ_IDLE,     // Healthy, waiting for its next cadence slot
+    ACQ_RETRY,    // Last attempt failed, waiting out the backoff
+    ACQ_OFFLINE   // Retries exhausted, probed at the maximum backoff
+};
+
+// Per-sensor acquisition state advanced by Sensors::tick()
+struct AcquisitionState {
+    AcquisitionPhase phase;
+    unsigned long interval;     // Cadence while healthy
+    unsigned long lastAttempt;
+    unsigned long wait;         // Delay before the next attempt
+    unsigned long backoff;      // Retry delay, doubles on each failure
+    uint8_t failures;           // Consecutive failures
+    bool started;               // startSensor() succeeded
+};
+
+// BMP280 trimming parameters, read once after the device comes up
+struct Bmp280Calibration {
+    uint16_t t1;
+    int16_t t2;
+    int16_t t3;
+    uint16_t p1;
+    int16_t p2;
+    int16_t p3;
+    int16_t p4;
+    int16_t p5;
+    int16_t p6;
+    int16_t p7;
+    int16_t p8;
+    int16_t p9;
+};
+
+// Causes recorded in the error log
+enum SensorErrorCode {
+    ERROR_READ_FAILED,      // Device returned no data
+    ERROR_OUT_OF_RANGE,     // Reading outside the plausible range
+    ERROR_OFFLINE,          // Retries exhausted
+    ERROR_SELF_TEST,        // Failed performSelfTest()
+    ERROR_BUS,              // I2C device did not acknowledge
+    ERROR_IMPORT_CORRUPT,   // importData() hit a bad block
+    ERROR_GLITCH,           // Unconfirmed outlier flagged by the anomaly detector
+    ERROR_CODE_COUNT
+};
+
+// Fixed-size error log entry, sensor is SENSOR_COUNT for system errors
+struct ErrorRecord {
+    unsigned long timestamp;
+    float value;                // Offending reading, NAN when not applicable
+    uint8_t sensor;
+    uint8_t code;
+};
+
+// Latest raw values published by the acquisition engine
+struct SensorReadings {
+    float temperature;
+    float humidity;
+    float lux;
+    float pressure;             // hPa
+    float bmpTemperature;
+    float airPPM;
+    int ldrRaw;
+    bool raining;
+    int soilRaw;
+    int uvRaw;
+    int waterRaw;
+    bool valid[SENSOR_COUNT];
+    unsigned long timestamp[SENSOR_COUNT];
+    unsigned long sequence;     // Incremented on every publish
+};
+
+// Fields of SensorData, used for per-field validity and freshness
+enum SensorField {
+    FIELD_TEMPERATURE,
+    FIELD_HUMIDITY,
+    FIELD_PRESSURE,
+    FIELD_ALTITUDE,
+    FIELD_DEW_POINT,
+    FIELD_HEAT_INDEX,
+    FIELD_MOTION,
+    FIELD_LIGHT,
+    FIELD_RAIN,
+    FIELD_AIR_QUALITY,
+    FIELD_CO2,
+    FIELD_GAS,
+    FIELD_AQI,
+    FIELD_SOIL_MOISTURE,
+    FIELD_UV,
+    FIELD_WATER_LEVEL,
+    FIELD_NOISE,
+    FIELD_PREDICTED_TEMPERATURE,
+    SENSOR_FIELD_COUNT
+};
+
+#define FIELD_BIT(field) (1UL << (field))
+
+// Change-notification limits for one field
+struct ChangeThreshold {
+    float deadband;       // Change needed before a quiet field is reported
+    float hysteresis;     // Deadband reduction while the field keeps moving
+};
+
+// One consistent view of every sensor, filled by Sensors::readSnapshot()
+struct SensorData {
+    float temperature;
+    float humidity;
+    float pressure;
+    float altitude;
+    float dewPoint;
+    float heatIndex;
+    bool motion;
+    float lightLevel;
+    bool isRaining;
+    float airQuality;
+    float co2Level;
+    float gasLevel;
+    float airQualityIndex;
+    float soilMoisture;
+    float uvIndex;
+    float waterLevel;
+    float noiseLevel;
+    float predictedTemperature;     // Forecast FORECAST_LOOKAHEAD_HOURS ahead
+    
+    unsigned long timestamp;
+    uint32_t validFields;                          // Bit per SensorField
+    uint32_t suspectFields;                        // Current value is an unconfirmed outlier
+    uint32_t anomalyFields;                        // Confirmed excursion within ANOMALY_HOLD_MS
+    uint32_t changedFields;                        // Moved past its deadband since the last snapshot
+    unsigned long fieldTime[SENSOR_FIELD_COUNT];   // Acquisition time per field
+};
+
 // New maintenance prediction structure
 struct MaintenancePrediction {
     bool requiresMaintenance;
@@ -61,7 +222,23 @@ struct MaintenancePrediction {
 class Sensors {
 public:
     Sensors(uint8_t dhtPin, uint8_t pirPin, uint8_t ldrPin);
-    void begin();
+    void begin(uint8_t airPin);     // MQ135 analog output
+    
+    // Non-blocking acquisition, call every loop pass
+    bool tick();
+    const SensorReadings& getReadings() const;
+    bool hasReadings() const;   // False until the first device has published
+    
+    // Fill every field, derived ones included, from the published readings
+    bool readSnapshot(SensorData& data);
+    bool isFieldValid(const SensorData& data, SensorField field) const;
+    float getFieldValue(const SensorData& data, SensorField field) const;
+    
+    // Change notification: changedFields of each snapshot is measured
+    // against the values reported by the previous snapshot
+    void setChangeThreshold(SensorField field, float deadband, float hysteresis = 0);
+    unsigned long getFieldAge(const SensorData& data, SensorField field) const;
+    AcquisitionPhase getAcquisitionPhase(SensorId sensor) const;
     
     // Enhanced environmental readings
     float getTemperature();
@@ -111,7 +288,7 @@ public:
     void updateSensorFusion();
     
     // New predictive analytics
-    float getPredictedTemperature(int hoursAhead);
+    float getPredictedTemperature(float hoursAhead);
     float getComfortIndex();
     float getAirQualityIndex();
     bool isPrecipitationLikely();
@@ -125,31 +302,60 @@ public:
     void calibrateUVSensor();
     void setSensorCalibration(const SensorCalibration& calibration);
     void setSensorThresholds(const SensorThresholds& thresholds);
-    void setUpdateInterval(unsigned long interval);
+    void setUpdateInterval(unsigned long interval);   // Slowest a stable sensor may be polled
+    void setAdaptiveSampling(bool enabled);
+    
+    // Adaptive sampling report
+    float getEffectiveRate(SensorId sensor) const;        // Samples per second
+    long getBusTimeSaved(SensorId sensor) const;          // Microseconds versus fixed cadences
+    void printSamplingStats(Print& out) const;
     
-    // Enhanced diagnostics
+    // Enhanced diagnostics, offline devices are restarted by the self-test
     bool performSelfTest();
     float getBatteryLevel();
     bool getSensorStatus(const String& sensorName);
-    void getErrorLog(String& log);
     float getSensorReliability(const String& sensorName);
+    float getSensorReliability(SensorId sensor) const;
+    
+    // Error log, formatted only when printed
+    void getErrorLog(Print& out) const;
+    int getErrorLogSize() const;
+    ErrorRecord getErrorRecord(int index) const;   // 0 is the oldest
+    void clearErrorLog();
+    unsigned long getErrorCount() const;
+    uint16_t getErrorCount(SensorId sensor) const;
+    float getErrorRate(SensorId sensor) const;            // Failed share of recent attempts
+    AnomalyState getAnomalyState(SensorField field) const;
     
     // New data management
+    const SensorHistory& getTemperatureHistory() const;
+    const SensorHistory& getHumidityHistory() const;
+    const SensorHistory& getPressureHistory() const;
+    const SensorHistory& getAirQualityHistory() const;
+    const ChannelStats& getTemperatureStats() const;
+    const ChannelStats& getHumidityStats() const;
+    const ChannelStats& getPressureStats() const;
+    const ChannelStats& getAirQualityStats() const;
     void clearHistory();
-    void exportData(String& data);
-    bool importData(const String& data);
+    // Stream history in the compact block format of timeseries_codec.h
+    void exportData(Print& out);
+    // Two passes over the stream: the whole file is checked before the live
+    // history is touched, then rewind(context) restarts it for the restore
+    bool importData(Stream& in, StreamRewind rewind, void* context);
     
 private:
     DHT dht;
     uint8_t pirPin;
     uint8_t ldrPin;
     uint8_t rainPin;
+    uint8_t airPin;
     BH1750 lightMeter;
     Adafruit_BMP280 bmp;
-    MQ135 airSensor;
     
     // Enhanced configuration
     SensorCalibration calibration;
+    CalibrationTable airTable;     // ADC counts to ppm
+    CalibrationTable uvTable;      // ADC counts to UV index x100
     SensorThresholds thresholds;
     unsigned long updateInterval;
     
@@ -159,21 +365,64 @@ private:
     unsigned long lastUpdate;
     bool sensorError;
     
-    // Enhanced history tracking
-    static const int HISTORY_SIZE = 24;
-    CircularBuffer<float, HISTORY_SIZE> tempHistory;
-    CircularBuffer<float, HISTORY_SIZE> humidityHistory;
-    CircularBuffer<float, HISTORY_SIZE> pressureHistory;
-    CircularBuffer<float, HISTORY_SIZE> airQualityHistory;
+    // Enhanced history tracking with minute/hour/day rollups
+    SensorHistory tempHistory;
+    SensorHistory humidityHistory;
+    SensorHistory pressureHistory;
+    SensorHistory airQualityHistory;
+    
+    // Streaming statistics, updated once per acquired sample
+    ChannelStats tempStats;
+    ChannelStats humidityStats;
+    ChannelStats pressureStats;
+    ChannelStats airQualityStats;
+    
+    // Streaming anomaly detection, one detector per measured channel
+    AnomalyDetector tempAnomaly;
+    AnomalyDetector humidityAnomaly;
+    AnomalyDetector pressureAnomaly;
+    AnomalyDetector lightAnomaly;
+    AnomalyDetector airAnomaly;
+    AnomalyDetector soilAnomaly;
+    AnomalyDetector uvAnomaly;
+    AnomalyDetector waterAnomaly;
+    
+    // Change-notification state per SensorField
+    ChangeThreshold changeThresholds[SENSOR_FIELD_COUNT];
+    float reportedValue[SENSOR_FIELD_COUNT];
+    uint32_t reportedValid;
+    uint32_t movingFields;
+    
+    // Daily-seasonal temperature forecaster, fed with every DHT sample
+    SeasonalForecaster temperatureForecast;
     
     // New sensor fusion
     SensorFusion lastFusion;
     float confidenceScore;
+    TemperatureFusion temperatureFusion;
+    ScalarFilter humidityFilter;
+    ScalarFilter pressureFilter;
+    unsigned long fusedDhtTime;
+    unsigned long fusedBmpTime;
     
     // Enhanced error logging
-    String errorLog;
-    int errorCount;
+    static const uint8_t ERROR_LOG_SIZE = 32;
+    CircularBuffer<ErrorRecord, ERROR_LOG_SIZE> errorLog;
+    unsigned long errorCount;
+    uint16_t sensorErrors[SENSOR_COUNT];
+    float errorRate[SENSOR_COUNT];
 
+    // Acquisition engine state
+    static const unsigned long RETRY_BACKOFF_MS = 100;
+    static const unsigned long MAX_BACKOFF_MS = 30000;
+    static const uint8_t MAX_RETRIES = 3;
+    AcquisitionState acquisition[SENSOR_COUNT];
+    AdaptiveSampler samplers[SENSOR_COUNT];
+    SensorReadings pending;
+    SensorReadings published;
+    uint8_t bmpAddress;
+    Bmp280Calibration bmpCalibration;
+    
     // Fix: Add last valid readings storage
     float lastValidTemperature;
     float lastValidHumidity;
@@ -193,19 +442,49 @@ private:
     SensorStatus pressureSensorStatus;
     SensorStatus lightSensorStatus;
     
+    // Acquisition helpers
+    void initAcquisition(SensorId sensor, unsigned long minInterval, unsigned long interval,
+                         unsigned long maxInterval);
+    bool startSensor(SensorId sensor);
+    bool probeSensor(SensorId sensor);
+    bool readSensor(SensorId sensor, unsigned long now);
+    void handleAcquisitionSuccess(SensorId sensor, unsigned long now);
+    void handleAcquisitionFailure(SensorId sensor);
+    void recordStatus(SensorId sensor, bool working, unsigned long now);
+    float sampleChange(SensorId sensor) const;
+    unsigned long readCost(SensorId sensor) const;
+    float airQualityScore(float ppm);
+    bool readBmpCalibration();
+    bool readBmpBurst(float& temperature, float& pressure);
+    bool readLightBurst(float& lux);
+    void checkAnomaly(AnomalyDetector& detector, SensorId sensor, float value, unsigned long now);
+    const AnomalyDetector* anomalyDetector(SensorField field) const;
+    float glitchRate(SensorId sensor) const;
+    
     // Enhanced helper methods
     float calculateAverage(float readings[], int count);
-    float calculateTrend(float history[], int count);
-    void updateHistory(float value, float history[]);
+    float calculateTrend(const SensorHistory& history, HistoryResolution resolution);
+    void updateHistory(float value, SensorHistory& history, ChannelStats& stats);
     float calculateDewPoint(float temperature, float humidity);
-    void logError(const String& error);
+    float calculateHeatIndex(float temperature, float humidity);
+    float calculateAltitude(float pressure);
+    float calculateAirQualityIndex(float ppm);
+    void setField(SensorData& data, SensorField field, SensorId source);
+    void setDerivedField(SensorData& data, SensorField field, SensorField first, SensorField second);
+    void updateChangedFields(SensorData& data);
+    void logError(uint8_t sensor, SensorErrorCode code, float value = NAN);
     bool validateReading(float value, float min, float max);
     void updateSensorStatus();
     float applyCalibration(float value, float offset);
+    float scaleAnalog(int raw, int span, bool inverted, float offset);
+    void buildAirTable();
+    void buildUVTable();
     float calculateReliability(const String& sensorName);
+    int sensorIdFromName(const String& sensorName) const;
+    SensorHistory* historyForChannel(uint8_t channel);
     
     // New analytics methods
-    float predictValue(float history[], int count, int hoursAhead);
+    float predictValue(const SensorHistory& history, float hoursAhead);
     float calculateConfidence(float value, float min, float max);
     void updateMaintenanceMetrics();
 };
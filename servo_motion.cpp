@@ -0,0 +1,83 @@
+#include "servo_motion.h"
+
+// Longest step integrated at once, a stalled loop must not teleport the servo
+static const float MAX_STEP_SECONDS = 0.1;
+// Creep speed near the target so braking never stalls short of it
+static const float MIN_SPEED_FRACTION = 0.05;
+
+ServoMotion::ServoMotion(float maxSpeed, float acceleration)
+    : maxSpeed(maxSpeed), acceleration(acceleration) {
+    reset(0.0);
+}
+
+void ServoMotion::reset(float position) {
+    current = position;
+    goal = position;
+    speed = 0.0;
+    lastUpdate = 0;
+    moving = false;
+}
+
+void ServoMotion::moveTo(float target) {
+    goal = target;
+    if (!moving && target != current) {
+        moving = true;
+        lastUpdate = millis();
+    }
+}
+
+void ServoMotion::stop() {
+    goal = current;
+    speed = 0.0;
+    moving = false;
+}
+
+bool ServoMotion::update(unsigned long now) {
+    if (!moving) return false;
+    
+    // Callers may pass a timestamp taken before moveTo()
+    if ((long)(now - lastUpdate) <= 0) return false;
+    float dt = (now - lastUpdate) / 1000.0;
+    if (dt > MAX_STEP_SECONDS) dt = MAX_STEP_SECONDS;
+    lastUpdate = now;
+    
+    float remaining = goal - current;
+    float direction = remaining >= 0 ? 1.0 : -1.0;
+    float towards = speed * direction;    // Velocity component towards the goal
+    
+    if (towards < 0) {
+        // Retargeted behind us: brake before reversing
+        towards = min(towards + acceleration * dt, (float)0.0);
+    } else if (towards * towards / (2.0 * acceleration) >= fabs(remaining)) {
+        towards = max(towards - acceleration * dt, maxSpeed * MIN_SPEED_FRACTION);
+    } else {
+        towards = min(towards + acceleration * dt, maxSpeed);
+    }
+    
+    float step = towards * dt;
+    if (step >= fabs(remaining)) {
+        current = goal;
+        speed = 0.0;
+        moving = false;
+        return true;
+    }
+    current += step * direction;
+    speed = towards * direction;
+    return false;
+}
+
+float ServoMotion::position() const {
+    return current;
+}
+
+float ServoMotion::target() const {
+    return goal;
+}
+
+float ServoMotion::velocity() const {
+    return speed;
+}
+
+bool ServoMotion::isMoving() const {
+    return moving;
+}
\ No newline at end of file
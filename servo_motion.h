@@ -0,0 +1,36 @@
+#ifndef SERVO_MOTION_H
+#define SERVO_MOTION_H
+
+#include <Arduino.h>
+
+// Trapezoidal velocity profile for one hobby servo: accelerate to the speed
+// limit, cruise, and brake in time to stop on the target. Advanced from
+// update() with the current time, so several servos move together without
+// blocking the loop. Positions are in degrees.
+class ServoMotion {
+public:
+    // Speed limit in degrees per second, acceleration in degrees per second^2
+    ServoMotion(float maxSpeed = 90.0, float acceleration = 180.0);
+
+    void reset(float position);        // Hold here, no motion
+    void moveTo(float target);         // Retargeting mid-move keeps the velocity
+    void stop();                       // Hold the current position
+    // Advance to now, returns true on the update that reaches the target
+    bool update(unsigned long now);
+
+    float position() const;
+    float target() const;
+    float velocity() const;            // Signed, degrees per second
+    bool isMoving() const;
+
+private:
+    float maxSpeed;
+    float acceleration;
+    float current;
+    float goal;
+    float speed;
+    unsigned long lastUpdate;
+    bool moving;
+};
+
+#endif
\ No newline at end of file
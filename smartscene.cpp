@@ -3,6 +3,10 @@
 SmartScenes::SmartScenes()
     : sceneCount(0), maxScenes(10), transitionDuration(5) {
     scenes = new Scene[maxScenes];
+    schedules = new TimerHandle[maxScenes];
+    for (int i = 0; i < maxScenes; i++) {
+        schedules[i] = 0;
+    }
 }
 
 void SmartScenes::begin() {
@@ -71,10 +75,31 @@ void SmartScenes::interpolateSettings(const Scene& from, const Scene& to, float
 }
 
 void SmartScenes::scheduleScene(const String& name, int hour, int minute) {
-    // Add scene to scheduler
-    automation.addScheduledTask(name, hour, minute, [this, name]() {
-        this->activateScene(name);
-    });
+    int index = findScene(name);
+    if (index < 0) return;
+    
+    // One daily activation per scene, rescheduling replaces it
+    automation.cancelScheduledTask(schedules[index]);
+    schedules[index] = automation.addScheduledTask(name, hour, minute, activateScheduled, this, index);
+}
+
+void SmartScenes::cancelSchedule(const String& name) {
+    int index = findScene(name);
+    if (index < 0) return;
+    automation.cancelScheduledTask(schedules[index]);
+    schedules[index] = 0;
+}
+
+void SmartScenes::activateScheduled(void* context, uint16_t index) {
+    SmartScenes* smartScenes = static_cast<SmartScenes*>(context);
+    smartScenes->activateScene(smartScenes->scenes[index].name);
+}
+
+int SmartScenes::findScene(const String& name) {
+    for (int i = 0; i < sceneCount; i++) {
+        if (scenes[i].name == name) return i;
+    }
+    return -1;
 }
 
 float SmartScenes::getSceneEfficiency(const String& name) {
@@ -101,8 +126,9 @@ void SmartScenes::optimizeScene(const String& name) {
             Scene& scene = scenes[i];
             
             // Optimize temperature based on time of day
+            // Without a wall clock the day temperature is the safe default
             int hour = automation.getCurrentHour();
-            if (hour >= 22 || hour < 6) {
+            if (hour >= 22 || (hour >= 0 && hour < 6)) {
                 scene.temperature = 20.0; // Night temperature
             } else {
                 scene.temperature = 23.0; // Day temperature
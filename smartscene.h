@@ -39,11 +39,14 @@ public:
     
 private:
     Scene* scenes;
+    TimerHandle* schedules;     // Daily activation task per scene, 0 when unscheduled
     int sceneCount;
     int maxScenes;
     int transitionDuration;
     
     // Helper methods
+    static void activateScheduled(void* context, uint16_t index);
+    int findScene(const String& name);
     bool validateScene(const Scene& scene);
     void interpolateSettings(const Scene& from, const Scene& to, float progress);
     void saveScenes();
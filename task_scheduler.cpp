@@ -0,0 +1,140 @@
+#include "task_scheduler.h"
+
+TaskScheduler scheduler;
+
+TaskScheduler::TaskScheduler() : count(0) {
+}
+
+TaskId TaskScheduler::add(const __FlashStringHelper* name, TaskFunction function, unsigned long period,
+                          TaskPriority priority, unsigned long budget, void* context) {
+    if (count == MAX_TASKS || !function) return -1;
+    
+    Task& task = tasks[count];
+    task.name = name;
+    task.function = function;
+    task.context = context;
+    task.period = period;
+    task.budget = budget;
+    task.nextRun = millis();
+    task.priority = priority;
+    task.enabled = true;
+    task.armed = period > 0;
+    task.runs = 0;
+    task.misses = 0;
+    task.overruns = 0;
+    task.maxDuration = 0;
+    task.maxLateness = 0;
+    return count++;
+}
+
+void TaskScheduler::schedule(TaskId id, unsigned long delay) {
+    if (id < 0 || id >= count) return;
+    tasks[id].nextRun = millis() + delay;
+    tasks[id].armed = true;
+}
+
+void TaskScheduler::setEnabled(TaskId id, bool enabled) {
+    if (id < 0 || id >= count) return;
+    tasks[id].enabled = enabled;
+}
+
+void TaskScheduler::setPeriod(TaskId id, unsigned long period) {
+    if (id < 0 || id >= count) return;
+    Task& task = tasks[id];
+    task.period = period;
+    if (period > 0 && !task.armed) {
+        task.nextRun = millis();
+        task.armed = true;
+    }
+}
+
+int TaskScheduler::nextDue(unsigned long now) const {
+    // Highest priority first, the longest waiting among equals
+    int best = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        const Task& task = tasks[i];
+        if (!task.enabled || !task.armed || (long)(now - task.nextRun) < 0) continue;
+        if (best < 0 || task.priority > tasks[best].priority ||
+            (task.priority == tasks[best].priority && (long)(task.nextRun - tasks[best].nextRun) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void TaskScheduler::service(unsigned long slice) {
+    unsigned long start = micros();
+    bool ranAny = false;
+    
+    while (true) {
+        int index = nextDue(millis());
+        if (index < 0) break;
+        
+        // The first task of a pass always runs, so nothing starves
+        Task& task = tasks[index];
+        unsigned long used = micros() - start;
+        if (ranAny && task.priority < TASK_CRITICAL && used + task.budget > slice) break;
+        
+        run(task, millis());
+        ranAny = true;
+    }
+}
+
+void TaskScheduler::run(Task& task, unsigned long now) {
+    unsigned long lateness = now - task.nextRun;
+    if (task.period > 0) {
+        // Starting a full period late misses the deadline, the skipped
+        // releases are dropped rather than run back to back
+        unsigned long missed = lateness / task.period;
+        task.misses += missed;
+        task.nextRun += (missed + 1) * task.period;
+        task.maxLateness = max(task.maxLateness, lateness);
+    } else {
+        task.armed = false;
+    }
+    
+    unsigned long started = micros();
+    task.function(task.context);
+    unsigned long duration = micros() - started;
+    
+    task.runs++;
+    if (duration > task.budget) task.overruns++;
+    task.maxDuration = max(task.maxDuration, duration);
+}
+
+unsigned long TaskScheduler::getRuns(TaskId id) const {
+    return id >= 0 && id < count ? tasks[id].runs : 0;
+}
+
+unsigned long TaskScheduler::getMisses(TaskId id) const {
+    return id >= 0 && id < count ? tasks[id].misses : 0;
+}
+
+unsigned long TaskScheduler::getOverruns(TaskId id) const {
+    return id >= 0 && id < count ? tasks[id].overruns : 0;
+}
+
+unsigned long TaskScheduler::getTotalMisses() const {
+    unsigned long total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        total += tasks[i].misses;
+    }
+    return total;
+}
+
+void TaskScheduler::printStats(Print& out) const {
+    for (uint8_t i = 0; i < count; i++) {
+        const Task& task = tasks[i];
+        out.print(task.name);
+        out.print(F(": runs "));
+        out.print(task.runs);
+        out.print(F(", missed "));
+        out.print(task.misses);
+        out.print(F(", over budget "));
+        out.print(task.overruns);
+        out.print(F(", max us "));
+        out.print(task.maxDuration);
+        out.print(F(", max late ms "));
+        out.println(task.maxLateness);
+    }
+}
\ No newline at end of file
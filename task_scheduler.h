@@ -0,0 +1,79 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+typedef void (*TaskFunction)(void* context);
+
+// Index into the task table, -1 when the table is full
+typedef int8_t TaskId;
+
+enum TaskPriority {
+    TASK_LOW,
+    TASK_NORMAL,
+    TASK_HIGH,
+    TASK_CRITICAL       // Runs even when the loop slice is spent
+};
+
+// Cooperative scheduler for the main loop. Each pass of service() runs the
+// due tasks one at a time, highest priority first, and picks again after
+// every task, so work that became due meanwhile (an emergency check) cuts
+// in ahead of lower priorities. A task is only started while its budget
+// still fits in the loop slice; the rest wait for the next pass.
+// Periodic tasks that start a whole period late count as deadline misses
+// and skip the missed releases instead of running back to back; tasks
+// running longer than their budget count as overruns.
+// Tasks with period 0 only run when armed with schedule().
+class TaskScheduler {
+public:
+    static const uint8_t MAX_TASKS = 12;
+    static const unsigned long DEFAULT_SLICE = 20000;      // us
+
+    TaskScheduler();
+
+    // Periods in ms, budgets in us. Periodic tasks run first on the next pass.
+    TaskId add(const __FlashStringHelper* name, TaskFunction function, unsigned long period,
+               TaskPriority priority, unsigned long budget, void* context = NULL);
+    // Run the task once delay ms from now; periodic tasks continue from there
+    void schedule(TaskId id, unsigned long delay = 0);
+    void setEnabled(TaskId id, bool enabled);
+    void setPeriod(TaskId id, unsigned long period);
+
+    // Run due tasks for up to slice us, call every loop pass
+    void service(unsigned long slice = DEFAULT_SLICE);
+
+    unsigned long getRuns(TaskId id) const;
+    unsigned long getMisses(TaskId id) const;
+    unsigned long getOverruns(TaskId id) const;
+    unsigned long getTotalMisses() const;
+    void printStats(Print& out) const;
+
+private:
+    struct Task {
+        const __FlashStringHelper* name;
+        TaskFunction function;
+        void* context;
+        unsigned long period;
+        unsigned long budget;
+        unsigned long nextRun;
+        uint8_t priority;
+        bool enabled;
+        bool armed;
+
+        unsigned long runs;
+        unsigned long misses;
+        unsigned long overruns;
+        unsigned long maxDuration;      // us
+        unsigned long maxLateness;      // ms
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t count;
+
+    int nextDue(unsigned long now) const;
+    void run(Task& task, unsigned long now);
+};
+
+extern TaskScheduler scheduler;
+
+#endif
\ No newline at end of file
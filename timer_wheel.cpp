@@ -0,0 +1,260 @@
+#include "timer_wheel.h"
+
+TimerWheel timers;
+
+static const uint16_t MINUTES_PER_DAY = 1440;
+static const uint16_t MINUTES_PER_WEEK = 10080;
+static const unsigned long MS_PER_MINUTE = 60000;
+static const unsigned long MS_PER_HOUR = 3600000;
+static const unsigned long MAX_DELAY = 0x7FFFFFFF;
+
+TimerWheel::TimerWheel()
+    : freeList(0), used(0), currentTick(0), lastTick(0), clockMinutes(0), clockAnchor(0), clockSet(false) {
+    for (uint16_t i = 0; i < LEVELS * SLOTS + 1; i++) {
+        lists[i] = NONE;
+    }
+    for (uint16_t i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+        tasks[i].generation = 0;
+        tasks[i].list = NO_LIST;
+        tasks[i].next = i + 1 < TIMER_WHEEL_CAPACITY ? i + 1 : NONE;
+    }
+}
+
+TimerHandle TimerWheel::schedule(unsigned long delay, TimerCallback callback, void* context, uint16_t arg) {
+    return add(delay, 0, NONE, callback, context, arg);
+}
+
+TimerHandle TimerWheel::scheduleEvery(unsigned long period, TimerCallback callback, void* context,
+                                      uint16_t arg) {
+    return add(period, max(period, (unsigned long)TICK_MS), NONE, callback, context, arg);
+}
+
+TimerHandle TimerWheel::scheduleDaily(uint8_t hour, uint8_t minute, TimerCallback callback,
+                                      void* context, uint16_t arg) {
+    return addCalendar(hour * 60 + minute, MINUTES_PER_DAY, callback, context, arg);
+}
+
+TimerHandle TimerWheel::scheduleWeekly(uint8_t day, uint8_t hour, uint8_t minute, TimerCallback callback,
+                                       void* context, uint16_t arg) {
+    return addCalendar((day % 7) * MINUTES_PER_DAY + hour * 60 + minute, MINUTES_PER_WEEK,
+                       callback, context, arg);
+}
+
+TimerHandle TimerWheel::addCalendar(uint16_t minuteOfWeek, uint16_t span, TimerCallback callback,
+                                    void* context, uint16_t arg) {
+    unsigned long delay = calendarDelay(minuteOfWeek, span, millis());
+    return add(delay, span * MS_PER_MINUTE, minuteOfWeek, callback, context, arg);
+}
+
+TimerHandle TimerWheel::add(unsigned long delay, unsigned long period, uint16_t calendar,
+                            TimerCallback callback, void* context, uint16_t arg) {
+    if (freeList == NONE || !callback) return 0;
+    
+    uint16_t index = freeList;
+    Task& task = tasks[index];
+    freeList = task.next;
+    used++;
+    
+    task.expires = tickAfter(delay, millis());
+    task.period = (period + TICK_MS / 2) / TICK_MS;
+    task.callback = callback;
+    task.context = context;
+    task.arg = arg;
+    task.calendar = calendar;
+    place(index);
+    return ((TimerHandle)task.generation << 16) | (index + 1);
+}
+
+uint32_t TimerWheel::tickAfter(unsigned long delay, unsigned long now) const {
+    // Rounded up from the start of the current tick, tasks never run early
+    delay = min(delay, MAX_DELAY);
+    uint32_t ticks = (now - lastTick + delay + TICK_MS - 1) / TICK_MS;
+    return currentTick + max(ticks, (uint32_t)1);
+}
+
+unsigned long TimerWheel::calendarDelay(uint16_t minuteOfWeek, uint16_t span, unsigned long now) const {
+    uint16_t current = this->minuteOfWeek(now) % span;
+    uint16_t minutes = (minuteOfWeek % span + span - current) % span;
+    if (minutes == 0) minutes = span;   // This minute has started, run at the next one
+    return minutes * MS_PER_MINUTE - (now - clockAnchor) % MS_PER_MINUTE;
+}
+
+bool TimerWheel::cancel(TimerHandle handle) {
+    int index = find(handle);
+    if (index < 0) return false;
+    release(index);
+    return true;
+}
+
+bool TimerWheel::isScheduled(TimerHandle handle) const {
+    return find(handle) >= 0;
+}
+
+unsigned long TimerWheel::remaining(TimerHandle handle) const {
+    int index = find(handle);
+    if (index < 0) return 0;
+    long ticks = (long)(tasks[index].expires - currentTick);
+    long ms = ticks * TICK_MS - (long)(millis() - lastTick);
+    return ms > 0 ? ms : 0;
+}
+
+int TimerWheel::find(TimerHandle handle) const {
+    uint16_t slot = handle & 0xFFFF;
+    if (slot == 0 || slot > TIMER_WHEEL_CAPACITY) return -1;
+    const Task& task = tasks[slot - 1];
+    if (task.generation != (uint16_t)(handle >> 16) || task.list == NO_LIST) return -1;
+    return slot - 1;
+}
+
+void TimerWheel::release(uint16_t index) {
+    Task& task = tasks[index];
+    if (task.list != NO_LIST) unlink(index);
+    task.generation++;      // Invalidates outstanding handles
+    task.next = freeList;
+    freeList = index;
+    used--;
+}
+
+void TimerWheel::link(uint16_t index, uint8_t list) {
+    Task& task = tasks[index];
+    task.list = list;
+    task.prev = NONE;
+    task.next = lists[list];
+    if (task.next != NONE) tasks[task.next].prev = index;
+    lists[list] = index;
+}
+
+void TimerWheel::unlink(uint16_t index) {
+    Task& task = tasks[index];
+    if (task.prev != NONE) {
+        tasks[task.prev].next = task.next;
+    } else {
+        lists[task.list] = task.next;
+    }
+    if (task.next != NONE) tasks[task.next].prev = task.prev;
+    task.list = NO_LIST;
+}
+
+void TimerWheel::place(uint16_t index) {
+    // Lowest ring whose span covers the remaining ticks
+    uint32_t tick = tasks[index].expires;
+    uint32_t delta = tick - currentTick;
+    // Due this tick only happens while cascading, just before the bucket runs
+    if ((int32_t)delta < 0) {
+        tick = currentTick + 1;
+        delta = 1;
+    }
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << (SLOT_BITS * (level + 1)))) level++;
+    if (delta >= (1UL << (SLOT_BITS * LEVELS))) {
+        // Beyond the top ring: park it as far out as possible, it is
+        // placed again when that bucket cascades
+        tick = currentTick + (1UL << (SLOT_BITS * LEVELS)) - 1;
+    }
+    link(index, level * SLOTS + ((tick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+}
+
+void TimerWheel::cascade(uint8_t level) {
+    // Spread the bucket that just came due over the rings below
+    uint8_t list = level * SLOTS + ((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    uint16_t index = lists[list];
+    lists[list] = NONE;
+    while (index != NONE) {
+        uint16_t next = tasks[index].next;
+        tasks[index].list = NO_LIST;
+        place(index);
+        index = next;
+    }
+}
+
+void TimerWheel::step() {
+    currentTick++;
+    for (uint8_t level = 1; level < LEVELS; level++) {
+        if ((currentTick & ((1UL << (SLOT_BITS * level)) - 1)) != 0) break;
+        cascade(level);
+    }
+    
+    // Collect the due bucket first, callbacks may schedule or cancel anything
+    uint8_t slot = currentTick & (SLOTS - 1);
+    uint16_t index;
+    while ((index = lists[slot]) != NONE) {
+        unlink(index);
+        link(index, READY_LIST);
+    }
+    
+    while ((index = lists[READY_LIST]) != NONE) {
+        Task& task = tasks[index];
+        TimerCallback callback = task.callback;
+        void* context = task.context;
+        uint16_t arg = task.arg;
+        
+        if (task.period > 0) {
+            unlink(index);
+            task.expires += task.period;
+            place(index);
+        } else {
+            release(index);
+        }
+        callback(context, arg);
+    }
+}
+
+void TimerWheel::service() {
+    unsigned long now = millis();
+    
+    // Move the clock anchor along so now - clockAnchor never wraps
+    while (now - clockAnchor >= MS_PER_HOUR) {
+        clockAnchor += MS_PER_HOUR;
+        clockMinutes = (clockMinutes + 60) % MINUTES_PER_WEEK;
+    }
+    
+    while (now - lastTick >= TICK_MS) {
+        lastTick += TICK_MS;
+        step();
+    }
+}
+
+void TimerWheel::setClock(uint8_t day, uint8_t hour, uint8_t minute) {
+    unsigned long now = millis();
+    clockMinutes = ((day % 7) * MINUTES_PER_DAY + hour * 60 + minute) % MINUTES_PER_WEEK;
+    clockAnchor = now;
+    clockSet = true;
+    
+    // Rare, so a pass over the pool is fine
+    for (uint16_t i = 0; i < TIMER_WHEEL_CAPACITY; i++) {
+        Task& task = tasks[i];
+        if (task.list == NO_LIST || task.list == READY_LIST || task.calendar == NONE) continue;
+        uint16_t span = task.period * TICK_MS / MS_PER_MINUTE;
+        unlink(i);
+        task.expires = tickAfter(calendarDelay(task.calendar, span, now), now);
+        place(i);
+    }
+}
+
+uint16_t TimerWheel::minuteOfWeek(unsigned long now) const {
+    return (clockMinutes + (now - clockAnchor) / MS_PER_MINUTE) % MINUTES_PER_WEEK;
+}
+
+bool TimerWheel::isClockSet() const {
+    return clockSet;
+}
+
+uint8_t TimerWheel::dayOfWeek() const {
+    return minuteOfWeek(millis()) / MINUTES_PER_DAY;
+}
+
+uint8_t TimerWheel::hour() const {
+    return minuteOfWeek(millis()) % MINUTES_PER_DAY / 60;
+}
+
+uint8_t TimerWheel::minute() const {
+    return minuteOfWeek(millis()) % 60;
+}
+
+uint16_t TimerWheel::size() const {
+    return used;
+}
+
+uint16_t TimerWheel::capacity() const {
+    return TIMER_WHEEL_CAPACITY;
+}
\ No newline at end of file
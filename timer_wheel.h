@@ -0,0 +1,112 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+// Size of the task pool, each task costs about 24 bytes of RAM. The wheel
+// itself scales to any count (handles index up to 65535 tasks); 1024 keeps
+// 24 KB within ESP8266-class RAM, define a larger value on bigger boards.
+#ifndef TIMER_WHEEL_CAPACITY
+#if defined(__AVR__)
+#define TIMER_WHEEL_CAPACITY 16
+#else
+#define TIMER_WHEEL_CAPACITY 1024
+#endif
+#endif
+
+typedef void (*TimerCallback)(void* context, uint16_t arg);
+
+// Pool index plus a generation count, so a stale handle never cancels a
+// reused task. 0 is never a valid handle.
+typedef uint32_t TimerHandle;
+
+// Hierarchical timing wheel: LEVELS rings of SLOTS buckets, each ring
+// SLOTS times coarser than the one below. Scheduling and cancelling are
+// O(1) list operations on a fixed pool, and a task only moves when the
+// ring above cascades into its bucket, so servicing does not get slower
+// as more tasks are scheduled. Expiry is kept in ticks relative to the
+// current tick, which makes millis() rollover harmless.
+class TimerWheel {
+public:
+    static const uint16_t TICK_MS = 125;
+    static const uint8_t SLOT_BITS = 5;
+    static const uint8_t SLOTS = 1 << SLOT_BITS;
+    static const uint8_t LEVELS = 4;    // 2^20 ticks, about 36 h; later tasks wait in the top ring
+
+    TimerWheel();
+
+    // Delays and periods in ms
+    TimerHandle schedule(unsigned long delay, TimerCallback callback, void* context = NULL,
+                         uint16_t arg = 0);
+    TimerHandle scheduleEvery(unsigned long period, TimerCallback callback, void* context = NULL,
+                              uint16_t arg = 0);
+    // Wall-clock tasks, repeating every day or every week (day 0 is Monday)
+    TimerHandle scheduleDaily(uint8_t hour, uint8_t minute, TimerCallback callback,
+                              void* context = NULL, uint16_t arg = 0);
+    TimerHandle scheduleWeekly(uint8_t day, uint8_t hour, uint8_t minute, TimerCallback callback,
+                               void* context = NULL, uint16_t arg = 0);
+    bool cancel(TimerHandle handle);
+    bool isScheduled(TimerHandle handle) const;
+    unsigned long remaining(TimerHandle handle) const;
+
+    // Wall-clock tasks are realigned whenever the clock is set. Nothing in
+    // this tree sets it yet: until a time source calls setClock(), boot
+    // counts as Monday 00:00 and daily/weekly tasks run relative to boot.
+    void setClock(uint8_t day, uint8_t hour, uint8_t minute);
+    bool isClockSet() const;
+    uint8_t dayOfWeek() const;
+    uint8_t hour() const;
+    uint8_t minute() const;
+
+    // Run every task that is due, call every loop pass
+    void service();
+    uint16_t size() const;
+    uint16_t capacity() const;
+
+private:
+    static const uint16_t NONE = 0xFFFF;
+    static const uint8_t READY_LIST = LEVELS * SLOTS;   // Due, about to run
+    static const uint8_t NO_LIST = 0xFF;
+
+    struct Task {
+        uint32_t expires;        // Tick
+        uint32_t period;         // Ticks, 0 for one-shot tasks
+        TimerCallback callback;
+        void* context;
+        uint16_t arg;
+        uint16_t calendar;       // Minute of the week for wall-clock tasks, NONE otherwise
+        uint16_t generation;
+        uint16_t next;
+        uint16_t prev;
+        uint8_t list;
+    };
+
+    Task tasks[TIMER_WHEEL_CAPACITY];
+    uint16_t lists[LEVELS * SLOTS + 1];
+    uint16_t freeList;
+    uint16_t used;
+    uint32_t currentTick;
+    unsigned long lastTick;          // millis() of currentTick
+    uint16_t clockMinutes;           // Minute of the week at clockAnchor
+    unsigned long clockAnchor;
+    bool clockSet;
+
+    TimerHandle add(unsigned long delay, unsigned long period, uint16_t calendar,
+                    TimerCallback callback, void* context, uint16_t arg);
+    TimerHandle addCalendar(uint16_t minuteOfWeek, uint16_t span, TimerCallback callback,
+                            void* context, uint16_t arg);
+    unsigned long calendarDelay(uint16_t minuteOfWeek, uint16_t span, unsigned long now) const;
+    uint32_t tickAfter(unsigned long delay, unsigned long now) const;
+    int find(TimerHandle handle) const;
+    void release(uint16_t index);
+    void link(uint16_t index, uint8_t list);
+    void unlink(uint16_t index);
+    void place(uint16_t index);
+    void cascade(uint8_t level);
+    void step();
+    uint16_t minuteOfWeek(unsigned long now) const;
+};
+
+extern TimerWheel timers;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "timeseries_codec.h"
+
+static const uint8_t MAGIC_0 = 'T';
+static const uint8_t MAGIC_1 = 'S';
+static const uint8_t FORMAT_VERSION = 1;
+static const uint8_t HEADER_SIZE = 16;
+static const uint8_t FLAG_RANGE = 0x80;
+static const uint8_t RESOLUTION_MASK = 0x0F;
+static const uint8_t MAX_POINT_BYTES = 5 * 5;   // Five varints of up to 5 bytes
+
+static uint16_t crc16(uint16_t crc, const uint8_t* data, size_t size) {
+    // CRC-16/CCITT, polynomial 0x1021
+    for (size_t i = 0; i < size; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t putVarint(uint8_t* out, uint32_t value) {
+    uint8_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[size++] = value;
+    return size;
+}
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void putUint32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = value >> (8 * i);
+    }
+}
+
+static uint32_t getUint32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static int32_t toHundredths(float value) {
+    return (int32_t)(value * 100 + (value >= 0 ? 0.5 : -0.5));
+}
+
+TimeSeriesEncoder::TimeSeriesEncoder(Print& out)
+    : out(out), length(0), count(0), channel(0), flags(0), written(0) {
+}
+
+void TimeSeriesEncoder::beginSeries(uint8_t newChannel, uint8_t resolution, bool hasRange) {
+    flushBlock();
+    channel = newChannel;
+    flags = (resolution & RESOLUTION_MASK) | (hasRange ? FLAG_RANGE : 0);
+}
+
+void TimeSeriesEncoder::add(const TimeSeriesPoint& point) {
+    uint8_t encoded[MAX_POINT_BYTES];
+    uint8_t size = 0;
+    int32_t value = toHundredths(point.value);
+
+    if (count > 0) {
+        long delta = (long)(point.timestamp - previousTimestamp);
+        size += putVarint(encoded + size, zigzag(delta - previousDelta));
+        size += putVarint(encoded + size, zigzag(value - previousValue));
+        previousDelta = delta;
+    }
+    if (flags & FLAG_RANGE) {
+        size += putVarint(encoded + size, max(value - toHundredths(point.min), (int32_t)0));
+        size += putVarint(encoded + size, max(toHundredths(point.max) - value, (int32_t)0));
+        size += putVarint(encoded + size, point.count);
+    }
+
+    // Start a new block when this point does not fit, it then becomes the
+    // block's first point and is re-encoded against the new header
+    if (count == 255 || length + size > BLOCK_PAYLOAD) {
+        flushBlock();
+        add(point);
+        return;
+    }
+
+    if (count == 0) {
+        firstTimestamp = point.timestamp;
+        firstValue = value;
+        previousDelta = 0;
+    }
+    memcpy(buffer + length, encoded, size);
+    length += size;
+    count++;
+    previousTimestamp = point.timestamp;
+    previousValue = value;
+}
+
+void TimeSeriesEncoder::finish() {
+    flushBlock();
+}
+
+void TimeSeriesEncoder::flushBlock() {
+    if (count == 0) return;
+
+    uint8_t header[HEADER_SIZE] = {MAGIC_0, MAGIC_1, FORMAT_VERSION, channel, flags, count,
+                                   length, 0};
+    putUint32(header + 8, firstTimestamp);
+    putUint32(header + 12, (uint32_t)firstValue);
+
+    uint16_t crc = crc16(0xFFFF, header, HEADER_SIZE);
+    crc = crc16(crc, buffer, length);
+    uint8_t trailer[2] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    out.write(header, HEADER_SIZE);
+    out.write(buffer, length);
+    out.write(trailer, 2);
+    written += HEADER_SIZE + length + 2;
+
+    count = 0;
+    length = 0;
+}
+
+unsigned long TimeSeriesEncoder::bytesWritten() const {
+    return written;
+}
+
+TimeSeriesDecoder::TimeSeriesDecoder(Stream& in)
+    : in(in), length(0), position(0), remaining(0), total(0), channel(0), flags(0),
+      corrupt(false) {
+}
+
+bool TimeSeriesDecoder::readExact(uint8_t* data, size_t size) {
+    return in.readBytes(data, size) == size;
+}
+
+bool TimeSeriesDecoder::readBlock() {
+    remaining = 0;
+    uint8_t header[HEADER_SIZE];
+    size_t received = in.readBytes(header, HEADER_SIZE);
+    if (received == 0) {
+        return false;  // Clean end of stream
+    }
+    if (received != HEADER_SIZE) {
+        corrupt = true;  // Truncated inside a header
+        return false;
+    }
+
+    uint16_t blockLength = header[6] | (header[7] << 8);
+    if (header[0] != MAGIC_0 || header[1] != MAGIC_1 || header[2] != FORMAT_VERSION ||
+        blockLength > TimeSeriesEncoder::BLOCK_PAYLOAD || header[5] == 0) {
+        corrupt = true;
+        return false;
+    }
+
+    uint8_t trailer[2];
+    if (!readExact(buffer, blockLength) || !readExact(trailer, 2)) {
+        corrupt = true;
+        return false;
+    }
+
+    uint16_t crc = crc16(crc16(0xFFFF, header, HEADER_SIZE), buffer, blockLength);
+    if ((trailer[0] | (trailer[1] << 8)) != crc) {
+        corrupt = true;
+        return false;
+    }
+
+    channel = header[3];
+    flags = header[4];
+    total = remaining = header[5];
+    length = blockLength;
+    position = 0;
+    previousTimestamp = getUint32(header + 8);
+    previousValue = (int32_t)getUint32(header + 12);
+    previousDelta = 0;
+    return true;
+}
+
+bool TimeSeriesDecoder::next(TimeSeriesPoint& point) {
+    if (remaining == 0) return false;
+
+    // Varint reader bounded by the block payload
+    uint32_t fields[5];
+    uint8_t needed = (remaining == total ? 0 : 2) + ((flags & FLAG_RANGE) ? 3 : 0);
+    for (uint8_t f = 0; f < needed; f++) {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        while (true) {
+            if (position >= length || shift > 28) {
+                corrupt = true;
+                remaining = 0;
+                return false;
+            }
+            uint8_t byte = buffer[position++];
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+        fields[f] = value;
+    }
+
+    uint8_t f = 0;
+    if (remaining != total) {
+        previousDelta += unzigzag(fields[f++]);
+        previousTimestamp += previousDelta;
+        previousValue += unzigzag(fields[f++]);
+    }
+
+    point.timestamp = previousTimestamp;
+    point.value = previousValue / 100.0;
+    if (flags & FLAG_RANGE) {
+        point.min = (previousValue - (int32_t)fields[f]) / 100.0;
+        point.max = (previousValue + (int32_t)fields[f + 1]) / 100.0;
+        point.count = fields[f + 2];
+    } else {
+        point.min = point.max = point.value;
+        point.count = 1;
+    }
+
+    remaining--;
+    return true;
+}
+
+uint8_t TimeSeriesDecoder::blockChannel() const {
+    return channel;
+}
+
+uint8_t TimeSeriesDecoder::blockResolution() const {
+    return flags & RESOLUTION_MASK;
+}
+
+bool TimeSeriesDecoder::blockHasRange() const {
+    return (flags & FLAG_RANGE) != 0;
+}
+
+bool TimeSeriesDecoder::isCorrupt() const {
+    return corrupt;
+}
\ No newline at end of file
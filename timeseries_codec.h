@@ -0,0 +1,91 @@
+#ifndef TIMESERIES_CODEC_H
+#define TIMESERIES_CODEC_H
+
+#include <Arduino.h>
+
+// Compact binary time-series format used for history export/import.
+//
+// A series is a run of self-contained blocks:
+//   header  'T' 'S' version channel flags count payloadLength(2)
+//           firstTimestamp(4) firstValue(4)
+//   payload per point: delta-of-delta timestamp, delta value (both zigzag
+//           varints, omitted for the first point), then mean-min, max-mean
+//           and count varints when the block carries rollups
+//   crc     CRC-16/CCITT over header and payload
+// Values are stored in hundredths. Integers are little endian.
+
+// Restart a stream from its first byte, false when it can't be rewound
+typedef bool (*StreamRewind)(void* context);
+
+struct TimeSeriesPoint {
+    unsigned long timestamp;
+    float value;        // Sample value, or mean of a rollup
+    float min;
+    float max;
+    uint16_t count;
+};
+
+class TimeSeriesEncoder {
+public:
+    static const uint8_t BLOCK_PAYLOAD = 96;
+
+    TimeSeriesEncoder(Print& out);
+
+    // Start a new series, flushing any pending block first
+    void beginSeries(uint8_t channel, uint8_t resolution, bool hasRange);
+    void add(const TimeSeriesPoint& point);
+    void finish();
+
+    unsigned long bytesWritten() const;
+
+private:
+    Print& out;
+    uint8_t buffer[BLOCK_PAYLOAD];
+    uint8_t length;
+    uint8_t count;
+    uint8_t channel;
+    uint8_t flags;
+
+    unsigned long firstTimestamp;
+    int32_t firstValue;
+    unsigned long previousTimestamp;
+    long previousDelta;
+    int32_t previousValue;
+    unsigned long written;
+
+    void flushBlock();
+};
+
+class TimeSeriesDecoder {
+public:
+    TimeSeriesDecoder(Stream& in);
+
+    // Load the next block into the fixed buffer, false at end or on a
+    // malformed/corrupt block (see isCorrupt)
+    bool readBlock();
+    bool next(TimeSeriesPoint& point);
+
+    uint8_t blockChannel() const;
+    uint8_t blockResolution() const;
+    bool blockHasRange() const;
+    bool isCorrupt() const;
+
+private:
+    Stream& in;
+    uint8_t buffer[TimeSeriesEncoder::BLOCK_PAYLOAD];
+    uint8_t length;
+    uint8_t position;
+    uint8_t remaining;
+    uint8_t total;
+    uint8_t channel;
+    uint8_t flags;
+    bool corrupt;
+
+    unsigned long previousTimestamp;
+    long previousDelta;
+    int32_t previousValue;
+
+    bool readExact(uint8_t* data, size_t size);
+};
+
+#endif
\ No newline at end of file
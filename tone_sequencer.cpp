@@ -0,0 +1,123 @@
+#include "tone_sequencer.h"
+
+ToneSequencer toneSequencer;
+
+#if defined(__AVR__)
+// Timer0 already runs for millis(); its compare B match fires once per
+// overflow cycle (1.024 ms) whatever OCR0B holds, so pin 5 PWM is unaffected.
+// Durations run about 2% long as a result.
+ISR(TIMER0_COMPB_vect) {
+    toneSequencer.tick();
+}
+#endif
+
+ToneSequencer::ToneSequencer()
+    : pin(0), notes(NULL), durations(NULL), singleFrequency(0), singleDuration(0), count(0),
+      index(0), remaining(0), playing(false), looping(false), currentPriority(TONE_CHIME),
+      lastService(0) {
+}
+
+void ToneSequencer::begin(uint8_t pin) {
+    this->pin = pin;
+    pinMode(pin, OUTPUT);
+    lastService = millis();
+#if defined(__AVR__)
+    TIMSK0 |= _BV(OCIE0B);
+#endif
+}
+
+bool ToneSequencer::claim(TonePriority priority) {
+    // Caller holds interrupts off
+    if (playing && priority < currentPriority) return false;
+    currentPriority = priority;
+    index = 0;
+    return true;
+}
+
+bool ToneSequencer::play(const int* notes, const int* durations, uint8_t count,
+                         TonePriority priority, bool loop) {
+    if (count == 0) return false;
+    
+    noInterrupts();
+    bool claimed = claim(priority);
+    if (claimed) {
+        this->notes = notes;
+        this->durations = durations;
+        this->count = count;
+        looping = loop;
+        startNote();
+        playing = true;
+    }
+    interrupts();
+    return claimed;
+}
+
+bool ToneSequencer::playTone(unsigned int frequency, unsigned int duration, TonePriority priority) {
+    noInterrupts();
+    bool claimed = claim(priority);
+    if (claimed) {
+        notes = NULL;
+        durations = NULL;
+        singleFrequency = frequency;
+        singleDuration = duration;
+        count = 1;
+        looping = false;
+        startNote();
+        playing = true;
+    }
+    interrupts();
+    return claimed;
+}
+
+void ToneSequencer::stop() {
+    noInterrupts();
+    playing = false;
+    currentPriority = TONE_CHIME;
+    noTone(pin);
+    interrupts();
+}
+
+void ToneSequencer::startNote() {
+    unsigned int frequency = notes ? pgm_read_word(&notes[index]) : singleFrequency;
+    unsigned int duration = durations ? pgm_read_word(&durations[index]) : singleDuration;
+    if (frequency > 0) {
+        tone(pin, frequency);
+    } else {
+        noTone(pin);
+    }
+    remaining = max(duration, 1U);
+}
+
+void ToneSequencer::tick() {
+    if (!playing || --remaining > 0) return;
+    
+    if (++index >= count) {
+        if (!looping) {
+            noTone(pin);
+            playing = false;
+            currentPriority = TONE_CHIME;
+            return;
+        }
+        index = 0;
+    }
+    startNote();
+}
+
+void ToneSequencer::service() {
+#if !defined(__AVR__)
+    unsigned long now = millis();
+    while (playing && lastService != now) {
+        lastService++;
+        tick();
+    }
+    lastService = now;
+#endif
+}
+
+bool ToneSequencer::isPlaying() const {
+    return playing;
+}
+
+TonePriority ToneSequencer::priority() const {
+    return (TonePriority)currentPriority;
+}
\ No newline at end of file
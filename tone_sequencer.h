@@ -0,0 +1,55 @@
+#ifndef TONE_SEQUENCER_H
+#define TONE_SEQUENCER_H
+
+#include <Arduino.h>
+
+// Higher priorities cut off whatever is playing
+enum TonePriority {
+    TONE_CHIME,         // Doorbell, confirmations
+    TONE_ALERT,
+    TONE_ALARM,
+    TONE_EVACUATION
+};
+
+// Plays note/duration sequences from PROGMEM on one buzzer pin. On AVR the
+// sequence is stepped from a Timer0 compare interrupt, so loop() does no
+// per-note work; other boards step it from service(). A 0 Hz note is a rest.
+class ToneSequencer {
+public:
+    ToneSequencer();
+    void begin(uint8_t pin);
+
+    // Both arrays in PROGMEM, durations in ms. Returns false when something
+    // more important is playing
+    bool play(const int* notes, const int* durations, uint8_t count,
+              TonePriority priority = TONE_CHIME, bool loop = false);
+    bool playTone(unsigned int frequency, unsigned int duration, TonePriority priority = TONE_ALERT);
+    void stop();
+
+    bool isPlaying() const;
+    TonePriority priority() const;
+
+    void service();     // Call every loop pass, no-op where the timer drives it
+    void tick();        // One millisecond elapsed, called from the interrupt
+
+private:
+    uint8_t pin;
+    const int* notes;
+    const int* durations;
+    unsigned int singleFrequency;     // playTone() notes live in RAM
+    unsigned int singleDuration;
+    volatile uint8_t count;
+    volatile uint8_t index;
+    volatile uint16_t remaining;      // ms left of the current note
+    volatile bool playing;
+    volatile bool looping;
+    volatile uint8_t currentPriority;
+    unsigned long lastService;
+
+    bool claim(TonePriority priority);
+    void startNote();
+};
+
+extern ToneSequencer toneSequencer;
+
+#endif
\ No newline at end of file